@@ -115,6 +115,21 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
 *
 **********************************************************************
 */
+/*********************************************************************
+*
+*       _Flush
+*
+*  Function description
+*    Writes the buffered characters to RTT once the buffer is full.
+*/
+static void _Flush(SEGGER_RTT_PRINTF_DESC * p) {
+  if (SEGGER_RTT_Write(p->RTTBufferIndex, p->pBuffer, p->Cnt) != p->Cnt) {
+    p->ReturnValue = -1;
+  } else {
+    p->Cnt = 0u;
+  }
+}
+
 /*********************************************************************
 *
 *       _StoreChar
@@ -132,99 +147,187 @@ static void _StoreChar(SEGGER_RTT_PRINTF_DESC * p, char c) {
   // Write part of string, when the buffer is full
   //
   if (p->Cnt == p->BufferSize) {
-    if (SEGGER_RTT_Write(p->RTTBufferIndex, p->pBuffer, p->Cnt) != p->Cnt) {
-      p->ReturnValue = -1;
-    } else {
-      p->Cnt = 0u;
+    _Flush(p);
+  }
+}
+
+/*********************************************************************
+*
+*       _StoreChars
+*
+*  Function description
+*    Appends a run of characters, checking for a full buffer once per
+*    chunk instead of once per character.
+*/
+static void _StoreChars(SEGGER_RTT_PRINTF_DESC * p, const char * s, unsigned NumChars) {
+  unsigned Cnt;
+  unsigned NumFree;
+  char*    pDest;
+
+  while ((NumChars != 0u) && (p->ReturnValue >= 0)) {
+    Cnt     = p->Cnt;
+    NumFree = p->BufferSize - Cnt;
+    if (NumFree > NumChars) {
+      NumFree = NumChars;
+    }
+    NumChars       -= NumFree;
+    p->Cnt          = Cnt + NumFree;
+    p->ReturnValue += (int)NumFree;
+    pDest           = p->pBuffer + Cnt;
+    while (NumFree--) {
+      *pDest++ = *s++;
+    }
+    if (p->Cnt == p->BufferSize) {
+      _Flush(p);
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _StorePad
+*
+*  Function description
+*    Appends NumChars copies of c, chunked like _StoreChars().
+*/
+static void _StorePad(SEGGER_RTT_PRINTF_DESC * p, char c, unsigned NumChars) {
+  unsigned Cnt;
+  unsigned NumFree;
+  char*    pDest;
+
+  while ((NumChars != 0u) && (p->ReturnValue >= 0)) {
+    Cnt     = p->Cnt;
+    NumFree = p->BufferSize - Cnt;
+    if (NumFree > NumChars) {
+      NumFree = NumChars;
+    }
+    NumChars       -= NumFree;
+    p->Cnt          = Cnt + NumFree;
+    p->ReturnValue += (int)NumFree;
+    pDest           = p->pBuffer + Cnt;
+    while (NumFree--) {
+      *pDest++ = c;
+    }
+    if (p->Cnt == p->BufferSize) {
+      _Flush(p);
     }
   }
 }
 
+/*********************************************************************
+*
+*       _DivMod10
+*
+*  Function description
+*    Divides by 10 with shifts and adds only (reciprocal approximation,
+*    corrected by one step), so cores without a hardware divider
+*    (Cortex-M0/M0+) do not have to call the runtime division routine.
+*/
+static unsigned _DivMod10(unsigned v, unsigned* pRem) {
+  unsigned q;
+  unsigned r;
+
+  q = (v >> 1) + (v >> 2);
+  q += (q >> 4);
+  q += (q >> 8);
+  q += (q >> 16);
+  q >>= 3;
+  r = v - ((q << 3) + (q << 1));
+  if (r > 9u) {
+    q++;
+    r -= 10u;
+  }
+  *pRem = r;
+  return q;
+}
+
 /*********************************************************************
 *
 *       _PrintUnsigned
+*
+*  Function description
+*    Renders the digits right to left into a local buffer, then appends
+*    them as one run. Base 16 uses shift/mask, base 10 uses _DivMod10().
+*    Sign ('-', '+' or 0 for none) goes before the digits and counts
+*    towards FieldWidth; zero padding goes between the two.
 */
-static void _PrintUnsigned(SEGGER_RTT_PRINTF_DESC * pBufferDesc, unsigned v, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+static void _PrintUnsigned(SEGGER_RTT_PRINTF_DESC * pBufferDesc, unsigned v, unsigned Base, char Sign, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
   static const char _aV2C[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-  unsigned Div;
-  unsigned Digit;
-  unsigned Number;
+  char     acDigits[32];
+  char*    pDigit;
+  unsigned Len;
   unsigned Width;
+  unsigned Rem;
+  unsigned Pad;
   char c;
 
-  Number = v;
-  Digit = 1u;
   //
-  // Get actual field width
+  // Convert, least significant digit first
   //
-  Width = 1u;
-  while (Number >= Base) {
-    Number = (Number / Base);
-    Width++;
+  pDigit = &acDigits[sizeof(acDigits)];
+  if (Base == 16u) {
+    do {
+      *--pDigit = _aV2C[v & 0xFu];
+      v >>= 4;
+    } while (v != 0u);
+  } else if (Base == 10u) {
+    do {
+      v = _DivMod10(v, &Rem);
+      *--pDigit = _aV2C[Rem];
+    } while (v != 0u);
+  } else {
+    do {
+      *--pDigit = _aV2C[v % Base];
+      v /= Base;
+    } while (v != 0u);
   }
+  Len = (unsigned)(&acDigits[sizeof(acDigits)] - pDigit);
+  //
+  // Get actual field width
+  //
+  Width = Len;
   if (NumDigits > Width) {
     Width = NumDigits;
   }
+  if ((FieldWidth > 0u) && (Sign != 0)) {
+    FieldWidth--;
+  }
   //
-  // Print leading chars if necessary
+  // Print leading chars if necessary, spaces before the sign, zeros after
   //
+  Pad = 0u;
+  c = ' ';
   if ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0u) {
-    if (FieldWidth != 0u) {
+    if (FieldWidth > Width) {
+      Pad = FieldWidth - Width;
       if (((FormatFlags & FORMAT_FLAG_PAD_ZERO) == FORMAT_FLAG_PAD_ZERO) && (NumDigits == 0u)) {
         c = '0';
-      } else {
-        c = ' ';
-      }
-      while ((FieldWidth != 0u) && (Width < FieldWidth)) {
-        FieldWidth--;
-        _StoreChar(pBufferDesc, c);
-        if (pBufferDesc->ReturnValue < 0) {
-          break;
-        }
       }
     }
   }
+  if (c == ' ') {
+    _StorePad(pBufferDesc, c, Pad);
+  }
+  if ((Sign != 0) && (pBufferDesc->ReturnValue >= 0)) {
+    _StoreChar(pBufferDesc, Sign);
+  }
+  if (c == '0') {
+    _StorePad(pBufferDesc, c, Pad);
+  }
   if (pBufferDesc->ReturnValue >= 0) {
     //
-    // Compute Digit.
-    // Loop until Digit has the value of the highest digit required.
-    // Example: If the output is 345 (Base 10), loop 2 times until Digit is 100.
+    // Print leading zeros requested by precision, then the digits
     //
-    while (1) {
-      if (NumDigits > 1u) {       // User specified a min number of digits to print? => Make sure we loop at least that often, before checking anything else (> 1 check avoids problems with NumDigits being signed / unsigned)
-        NumDigits--;
-      } else {
-        Div = v / Digit;
-        if (Div < Base) {        // Is our divider big enough to extract the highest digit from value? => Done
-          break;
-        }
-      }
-      Digit *= Base;
+    if (Width > Len) {
+      _StorePad(pBufferDesc, '0', Width - Len);
     }
-    //
-    // Output digits
-    //
-    do {
-      Div = v / Digit;
-      v -= Div * Digit;
-      _StoreChar(pBufferDesc, _aV2C[Div]);
-      if (pBufferDesc->ReturnValue < 0) {
-        break;
-      }
-      Digit /= Base;
-    } while (Digit);
+    _StoreChars(pBufferDesc, pDigit, Len);
     //
     // Print trailing spaces if necessary
     //
     if ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == FORMAT_FLAG_LEFT_JUSTIFY) {
-      if (FieldWidth != 0u) {
-        while ((FieldWidth != 0u) && (Width < FieldWidth)) {
-          FieldWidth--;
-          _StoreChar(pBufferDesc, ' ');
-          if (pBufferDesc->ReturnValue < 0) {
-            break;
-          }
-        }
+      if (FieldWidth > Width) {
+        _StorePad(pBufferDesc, ' ', FieldWidth - Width);
       }
     }
   }
@@ -233,77 +336,25 @@ static void _PrintUnsigned(SEGGER_RTT_PRINTF_DESC * pBufferDesc, unsigned v, uns
 /*********************************************************************
 *
 *       _PrintInt
+*
+*  Function description
+*    Splits off the sign and leaves the digits, and the width, to
+*    _PrintUnsigned(). The magnitude is taken in unsigned arithmetic,
+*    which is defined for INT_MIN too.
 */
 static void _PrintInt(SEGGER_RTT_PRINTF_DESC * pBufferDesc, int v, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
-  unsigned Width;
-  int Number;
-
-  Number = (v < 0) ? -v : v;
+  unsigned Magnitude;
+  char     Sign;
 
-  //
-  // Get actual field width
-  //
-  Width = 1u;
-  while (Number >= (int)Base) {
-    Number = (Number / (int)Base);
-    Width++;
-  }
-  if (NumDigits > Width) {
-    Width = NumDigits;
-  }
-  if ((FieldWidth > 0u) && ((v < 0) || ((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN))) {
-    FieldWidth--;
-  }
-
-  //
-  // Print leading spaces if necessary
-  //
-  if ((((FormatFlags & FORMAT_FLAG_PAD_ZERO) == 0u) || (NumDigits != 0u)) && ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0u)) {
-    if (FieldWidth != 0u) {
-      while ((FieldWidth != 0u) && (Width < FieldWidth)) {
-        FieldWidth--;
-        _StoreChar(pBufferDesc, ' ');
-        if (pBufferDesc->ReturnValue < 0) {
-          break;
-        }
-      }
-    }
-  }
-  //
-  // Print sign if necessary
-  //
-  if (pBufferDesc->ReturnValue >= 0) {
-    if (v < 0) {
-      v = -v;
-      _StoreChar(pBufferDesc, '-');
-    } else if ((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN) {
-      _StoreChar(pBufferDesc, '+');
-    } else {
-
-    }
-    if (pBufferDesc->ReturnValue >= 0) {
-      //
-      // Print leading zeros if necessary
-      //
-      if (((FormatFlags & FORMAT_FLAG_PAD_ZERO) == FORMAT_FLAG_PAD_ZERO) && ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0u) && (NumDigits == 0u)) {
-        if (FieldWidth != 0u) {
-          while ((FieldWidth != 0u) && (Width < FieldWidth)) {
-            FieldWidth--;
-            _StoreChar(pBufferDesc, '0');
-            if (pBufferDesc->ReturnValue < 0) {
-              break;
-            }
-          }
-        }
-      }
-      if (pBufferDesc->ReturnValue >= 0) {
-        //
-        // Print number without sign
-        //
-        _PrintUnsigned(pBufferDesc, (unsigned)v, Base, NumDigits, FieldWidth, FormatFlags);
-      }
-    }
+  Magnitude = (unsigned)v;
+  Sign = 0;
+  if (v < 0) {
+    Magnitude = 0u - Magnitude;
+    Sign = '-';
+  } else if ((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN) {
+    Sign = '+';
   }
+  _PrintUnsigned(pBufferDesc, Magnitude, Base, Sign, NumDigits, FieldWidth, FormatFlags);
 }
 
 /*********************************************************************
@@ -424,12 +475,12 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
         break;
       case 'u':
         v = va_arg(*pParamList, int);
-        _PrintUnsigned(&BufferDesc, (unsigned)v, 10u, NumDigits, FieldWidth, FormatFlags);
+        _PrintUnsigned(&BufferDesc, (unsigned)v, 10u, 0, NumDigits, FieldWidth, FormatFlags);
         break;
       case 'x':
       case 'X':
         v = va_arg(*pParamList, int);
-        _PrintUnsigned(&BufferDesc, (unsigned)v, 16u, NumDigits, FieldWidth, FormatFlags);
+        _PrintUnsigned(&BufferDesc, (unsigned)v, 16u, 0, NumDigits, FieldWidth, FormatFlags);
         break;
       case 's':
         {
@@ -446,7 +497,7 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
         break;
       case 'p':
         v = va_arg(*pParamList, int);
-        _PrintUnsigned(&BufferDesc, (unsigned)v, 16u, 8u, 8u, 0u);
+        _PrintUnsigned(&BufferDesc, (unsigned)v, 16u, 0, 8u, 8u, 0u);
         break;
       case '%':
         _StoreChar(&BufferDesc, '%');
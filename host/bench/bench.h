@@ -0,0 +1,134 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Shared by the host benchmarks. Times a loop with the CPU cycle
+ *          counter where the kernel lets us have it (perf_event), and with
+ *          CLOCK_MONOTONIC always, and prints one tab-separated row per
+ *          measurement:
+ *
+ *   benchmark  variant  parameter  iterations  ns_per_op  cycles_per_op
+ *
+ * cycles_per_op is "-" where no cycle counter is available. With --quick
+ * on the command line, every benchmark runs a hundredth of its iterations;
+ * ctest runs them that way, as a smoke test.
+ */
+
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static int  bench_cycles_fd = -1;
+static bool bench_quick     = false;
+
+// Only the options, for benchmarks that print a table of their own.
+static inline void bench_options(int argc, char ** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "--quick")) bench_quick = true;
+    }
+}
+
+static inline void bench_init(int argc, char ** argv)
+{
+    bench_options(argc, argv);
+
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+
+    bench_cycles_fd = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+
+    printf("benchmark\tvariant\tparameter\titerations\tns_per_op\tcycles_per_op\n");
+}
+
+static inline uint32_t bench_iterations(uint32_t iterations)
+{
+    if (bench_quick) iterations /= 100;
+
+    return iterations ? iterations : 1;
+}
+
+static inline uint64_t bench_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+static inline uint64_t bench_cycles(void)
+{
+    uint64_t cycles = 0;
+
+    if (bench_cycles_fd < 0 || read(bench_cycles_fd, &cycles, sizeof(cycles)) != sizeof(cycles)) return 0;
+
+    return cycles;
+}
+
+static inline void bench_report(const char * benchmark, const char * variant, uint32_t parameter,
+                                uint32_t iterations, uint64_t ns, uint64_t cycles)
+{
+    printf("%s\t%s\t%u\t%u\t%.1f\t", benchmark, variant, parameter, iterations, (double) ns / iterations);
+
+    if (bench_cycles_fd >= 0) printf("%.1f\n", (double) cycles / iterations);
+    else                      printf("-\n");
+}
+
+// Runs STATEMENT ITERATIONS times (fewer with --quick) and reports it.
+#define BENCH(BENCHMARK, VARIANT, PARAMETER, ITERATIONS, STATEMENT)                 \
+    do                                                                              \
+    {                                                                               \
+        uint32_t bench_count  = bench_iterations(ITERATIONS);                       \
+        uint64_t bench_cycles_start = bench_cycles();                               \
+        uint64_t bench_ns_start     = bench_ns();                                   \
+                                                                                    \
+        for (uint32_t bench_i = 0; bench_i < bench_count; bench_i++)                \
+        {                                                                           \
+            STATEMENT;                                                              \
+        }                                                                           \
+                                                                                    \
+        uint64_t bench_ns_total     = bench_ns() - bench_ns_start;                  \
+        uint64_t bench_cycles_total = bench_cycles() - bench_cycles_start;          \
+                                                                                    \
+        bench_report(BENCHMARK, VARIANT, PARAMETER, bench_count,                    \
+                     bench_ns_total, bench_cycles_total);                           \
+    } while (0)
+
+#endif /* HOST_BENCH_H */
@@ -0,0 +1,77 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: What the RTX5 thread event hooks add to every context switch
+ *          with DEBUG_THREAD_CPU_TIME and DEBUG_SCHED_LATENCY, on the host
+ *          shims: a switch alone, and a wake-up followed by the switch to
+ *          the woken thread, round robin over 1 to 32 threads.
+ *
+ * The library is included so the hooks are called the way RTX5 calls
+ * them, straight from the scheduler, without the shim's switch around
+ * them. cycles_per_op are host cycles; see the README for the target.
+ */
+
+#include "../../mbed_memory_status.cpp"
+
+#include "host_target.h"
+
+#include "bench.h"
+
+static void * bench_threads[32];
+
+static void bench_hooks(uint32_t threads)
+{
+    host_reset();
+
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        host_thread_config_t config = host_thread_config_t();
+
+        config.name       = "bench";
+        config.entry      = 0x00010001 + i * 0x100;
+        config.stack_size = 0x400;
+
+        bench_threads[i] = host_thread_create(&config);
+    }
+
+    uint32_t next = 0;
+
+    BENCH("EvrRtxThreadSwitched", "cpu+latency", threads, 2000000,
+          EvrRtxThreadSwitched((osThreadId_t) bench_threads[next]);
+          next = (next + 1) % threads);
+
+    BENCH("EvrRtxThreadUnblocked+Switched", "cpu+latency", threads, 2000000,
+          EvrRtxThreadUnblocked((osThreadId_t) bench_threads[next], 0);
+          EvrRtxThreadSwitched((osThreadId_t) bench_threads[next]);
+          next = (next + 1) % threads);
+}
+
+int main(int argc, char ** argv)
+{
+    bench_init(argc, argv);
+
+    for (uint32_t threads = 1; threads <= 32; threads *= 2) bench_hooks(threads);
+
+    return 0;
+}
@@ -0,0 +1,210 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: SEGGER_RTT_printf() against the implementation it replaced
+ *          (reference/, the file as it was before the integer formatting
+ *          was reworked).
+ *
+ * Every format in the table is first printed by both, and the output and
+ * return values have to be identical, or the program fails. The reference
+ * negated INT_MIN in int, so %d of INT_MIN is instead checked, with the
+ * other signed values, against the host's snprintf(). Then each integer
+ * conversion is timed with both.
+ *
+ * The host divides in hardware, so the decimal numbers here understate
+ * what the shift-and-add division saves on a Cortex-M0. The hex and the
+ * padding paths compare like for like.
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "RTT/SEGGER_RTT.h"
+
+#include "bench.h"
+
+extern "C" int reference_SEGGER_RTT_printf(unsigned BufferIndex, const char * sFormat, ...);
+
+typedef int (*printf_t)(unsigned BufferIndex, const char * sFormat, ...);
+
+// Buffer 0 has a fixed size, so a buffer of our own.
+static const unsigned BENCH_BUFFER = 1;
+static char           rtt_buffer[0x10000];
+
+// What one call wrote to up-buffer 1, NUL terminated. The buffer is
+// marked read after every call, so it never fills up.
+static int capture(printf_t print, const char * format, uint32_t value, char * out, uint32_t size)
+{
+    SEGGER_RTT_BUFFER_UP * up    = &_SEGGER_RTT.aUp[BENCH_BUFFER];
+    unsigned               start = up->WrOff;
+    int                    result;
+
+    result = print(BENCH_BUFFER, format, value);
+
+    uint32_t count = 0;
+
+    for (unsigned i = start; i != up->WrOff && count + 1 < size; i = (i + 1) % up->SizeOfBuffer)
+    {
+        out[count++] = up->pBuffer[i];
+    }
+
+    out[count] = '\0';
+    up->RdOff  = up->WrOff;
+
+    return result;
+}
+
+static const char * const FORMATS[] =
+{
+    "%u", "%d", "%x", "%X", "%c", "%p", "%%",
+    "%5u", "%-5u|", "%05u", "%.3u", "%8.4u", "%-8.4u|", "%08.4u", "%0u", "%.0u",
+    "%5d", "%-5d|", "%05d", "%+d", "%+5d", "%+05d", "%-+6d|", "%.4d", "%+.4d", "%010d",
+    "%8x", "%08x", "%-8X|", "%.8X", "%#x", "%#08X", "%2x",
+    "%.10u", "%.8x",                        // Widest precision the reference survives.
+    "%70u", "%-70u|", "%070d", "%-+70d|",   // Wider than the 64 byte printf buffer.
+    "[%u]", "a%ub", "%4c|", "%-4c|"
+};
+
+static const uint32_t VALUES[] =
+{
+    0, 1, 7, 9, 10, 11, 42, 99, 100, 255, 256, 999, 1000, 4095, 4096, 65535, 65536,
+    99999, 100000, 999999, 1000000, 9999999, 10000000, 99999999, 100000000,
+    999999999, 1000000000, 0x7FFFFFFF, 0x80000000, 0x80000001, 0xDEADBEEF,
+    0xFFFFFFF6, 0xFFFFFFFF, 4294967286U, 1234567890, 429496729, 429496730
+};
+
+// The reference overflows on these; see check_signed().
+static bool reference_overflows(const char * format, uint32_t value)
+{
+    return strchr(format, 'd') && value == (uint32_t) INT_MIN;
+}
+
+static bool check_equivalence(void)
+{
+    char     expected[256];
+    char     actual[256];
+    uint32_t cases  = 0;
+    bool     same   = true;
+
+    for (uint32_t f = 0; f < sizeof(FORMATS) / sizeof(FORMATS[0]); f++)
+    {
+        for (uint32_t v = 0; v < sizeof(VALUES) / sizeof(VALUES[0]); v++)
+        {
+            if (reference_overflows(FORMATS[f], VALUES[v])) continue;
+
+            int expected_result = capture(reference_SEGGER_RTT_printf, FORMATS[f], VALUES[v], expected, sizeof(expected));
+            int actual_result   = capture(SEGGER_RTT_printf, FORMATS[f], VALUES[v], actual, sizeof(actual));
+
+            if (expected_result != actual_result || strcmp(expected, actual))
+            {
+                fprintf(stderr, "\"%s\" with %08X: \"%s\" (%d), was \"%s\" (%d)\n",
+                        FORMATS[f], VALUES[v], actual, actual_result, expected, expected_result);
+                same = false;
+            }
+
+            cases++;
+        }
+    }
+
+    fprintf(stderr, "printf: %u cases compared\n", cases);
+
+    return same;
+}
+
+// Formats whose meaning is the same in SEGGER_RTT_printf() and C.
+static const char * const SIGNED_FORMATS[] =
+{
+    "%d", "%5d", "%-5d|", "%05d", "%+d", "%+5d", "%+05d", "%-+6d|", "%.4d", "%+.4d",
+    "%010d", "%12d", "%-12d|", "%012d", "%+012d", "%-+13d|", "%.11d", "%+.11d", "%15.11d"
+};
+
+static const int SIGNED_VALUES[] =
+{
+    0, 1, -1, 9, -9, 10, -10, 99, -99, 12345, -12345, 1000000000, -1000000000,
+    INT_MAX, INT_MIN + 1, INT_MIN
+};
+
+static bool check_signed(void)
+{
+    char     expected[256];
+    char     actual[256];
+    uint32_t cases = 0;
+    bool     same  = true;
+
+    for (uint32_t f = 0; f < sizeof(SIGNED_FORMATS) / sizeof(SIGNED_FORMATS[0]); f++)
+    {
+        for (uint32_t v = 0; v < sizeof(SIGNED_VALUES) / sizeof(SIGNED_VALUES[0]); v++)
+        {
+            // Output only: SEGGER_RTT_printf() counts the last partial
+            // buffer twice in its return value, as SEGGER's original does.
+            snprintf(expected, sizeof(expected), SIGNED_FORMATS[f], SIGNED_VALUES[v]);
+            capture(SEGGER_RTT_printf, SIGNED_FORMATS[f], (uint32_t) SIGNED_VALUES[v], actual, sizeof(actual));
+
+            if (strcmp(expected, actual))
+            {
+                fprintf(stderr, "\"%s\" with %d: \"%s\", snprintf \"%s\"\n",
+                        SIGNED_FORMATS[f], SIGNED_VALUES[v], actual, expected);
+                same = false;
+            }
+
+            cases++;
+        }
+    }
+
+    fprintf(stderr, "printf: %u signed cases compared with snprintf\n", cases);
+
+    return same;
+}
+
+static void bench_format(const char * name, const char * format, uint32_t value)
+{
+    SEGGER_RTT_BUFFER_UP * up = &_SEGGER_RTT.aUp[BENCH_BUFFER];
+
+    BENCH(name, "reference", value, 200000,
+          reference_SEGGER_RTT_printf(BENCH_BUFFER, format, value); up->RdOff = up->WrOff);
+
+    BENCH(name, "current", value, 200000,
+          SEGGER_RTT_printf(BENCH_BUFFER, format, value); up->RdOff = up->WrOff);
+}
+
+int main(int argc, char ** argv)
+{
+    SEGGER_RTT_ConfigUpBuffer(BENCH_BUFFER, "bench", rtt_buffer, sizeof(rtt_buffer), SEGGER_RTT_MODE_NO_BLOCK_TRIM);
+
+    if (!check_equivalence() || !check_signed()) return 1;
+
+    bench_init(argc, argv);
+
+    bench_format("printf %u",    "%u",    7);
+    bench_format("printf %u",    "%u",    4294967295U);
+    bench_format("printf %d",    "%d",    (uint32_t) -123456);
+    bench_format("printf %08X",  "%08X",  0xDEADBEEF);
+    bench_format("printf %x",    "%x",    0x1234);
+    bench_format("printf %10u",  "%10u",  1000);
+    bench_format("printf %-70u", "%-70u", 42);
+
+    return 0;
+}
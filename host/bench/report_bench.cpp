@@ -0,0 +1,176 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: What each stage of a report costs, on the host shims: the ISR
+ *          stack canary scan, number formatting, output dispatch, and the
+ *          whole thread report for 1 to 64 threads.
+ *
+ * The library is included rather than linked, so its static functions
+ * can be timed on their own. Serial output goes to the host's capture
+ * buffer with discard on, so what is timed is the library, not the
+ * buffer; RTT output goes to up-buffer 0 in the mode named by the variant.
+ */
+
+#include "../../mbed_memory_status.cpp"
+
+#include "host_target.h"
+
+#include "bench.h"
+
+static volatile uint32_t bench_sink;
+
+static void bench_isr_canary_scan(void)
+{
+    static const uint32_t USED[] = { 0x40, 0x200, 0x7F0 };
+
+    uint32_t * limit = &__StackLimit;
+    uint32_t * top   = &__StackTop;
+
+    for (uint32_t u = 0; u < sizeof(USED) / sizeof(USED[0]); u++)
+    {
+        uint32_t * used = top - USED[u] / 4;
+
+        for (uint32_t * word = limit; word < top; word++)
+        {
+            *word = (word < used) ? ISR_STACK_CANARY : 0;
+        }
+
+        BENCH("calculate_isr_stack_usage", "canary", USED[u], 200000,
+              bench_sink += calculate_isr_stack_usage());
+    }
+}
+
+static void bench_formatting(void)
+{
+    static const uint32_t VALUES[] = { 0, 0x1234, 0xDEADBEEF };
+
+    for (uint32_t v = 0; v < sizeof(VALUES) / sizeof(VALUES[0]); v++)
+    {
+        BENCH("debug_print_u32", "serial+rtt", VALUES[v], 200000, debug_print_u32(VALUES[v]));
+    }
+}
+
+// Keeps RTT up-buffer 0 empty, as a fast probe would.
+static void rtt_drain(void)
+{
+    _SEGGER_RTT.aUp[DEFAULT_RTT_UP_BUFFER].RdOff = _SEGGER_RTT.aUp[DEFAULT_RTT_UP_BUFFER].WrOff;
+}
+
+static uint32_t rtt_used(void)
+{
+    const SEGGER_RTT_BUFFER_UP * up = &_SEGGER_RTT.aUp[DEFAULT_RTT_UP_BUFFER];
+
+    return (up->WrOff + up->SizeOfBuffer - up->RdOff) % up->SizeOfBuffer;
+}
+
+static void bench_dispatch(void)
+{
+    static const char * const LABELS[] =
+    {
+        " ) ",
+        "    stack ( start: ",
+        "    (objects not tracked, raise CONTENTION_SLOTS)\r\n"
+    };
+
+    static const struct
+    {
+        const char * name;
+        unsigned     mode;
+        bool         drain;
+    } MODES[] =
+    {
+        { "rtt skip drained",  SEGGER_RTT_MODE_NO_BLOCK_SKIP,      true  },
+        { "rtt skip full",     SEGGER_RTT_MODE_NO_BLOCK_SKIP,      false },
+        { "rtt trim drained",  SEGGER_RTT_MODE_NO_BLOCK_TRIM,      true  },
+        { "rtt trim full",     SEGGER_RTT_MODE_NO_BLOCK_TRIM,      false },
+        { "rtt block drained", SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL, true  }
+    };
+
+    nway_print_label(""); // output_rtt_init() sets the mode on first use.
+
+    for (uint32_t m = 0; m < sizeof(MODES) / sizeof(MODES[0]); m++)
+    {
+        SEGGER_RTT_ConfigUpBuffer(DEFAULT_RTT_UP_BUFFER, NULL, NULL, 0, MODES[m].mode);
+
+        for (uint32_t l = 0; l < sizeof(LABELS) / sizeof(LABELS[0]); l++)
+        {
+            uint32_t length = (uint32_t) strlen(LABELS[l]);
+
+            if (MODES[m].drain)
+            {
+                BENCH("nway_print_label", MODES[m].name, length, 200000,
+                      nway_print_label(LABELS[l]); rtt_drain());
+            }
+            else
+            {
+                while (nway_print_label(LABELS[l]), rtt_used() < BUFFER_SIZE_UP - 64) {}
+
+                BENCH("nway_print_label", MODES[m].name, length, 200000,
+                      nway_print_label(LABELS[l]));
+            }
+        }
+
+        rtt_drain();
+    }
+
+    SEGGER_RTT_ConfigUpBuffer(DEFAULT_RTT_UP_BUFFER, NULL, NULL, 0, SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+}
+
+static void bench_thread_report(void)
+{
+    for (uint32_t threads = 1; threads <= 64; threads *= 2)
+    {
+        host_reset();
+        host_output_discard(true);
+
+        for (uint32_t i = 0; i < threads; i++)
+        {
+            host_thread_config_t config = host_thread_config_t();
+
+            config.name       = "bench";
+            config.entry      = 0x00010001 + i * 0x100;
+            config.stack_size = 0x400;
+            config.stack_used = 0x40 + i * 8;
+
+            host_thread_create(&config);
+        }
+
+        BENCH("print_all_thread_info", "serial+rtt", threads, 2000000 / (threads * 10),
+              print_all_thread_info(); rtt_drain());
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    bench_init(argc, argv);
+
+    host_output_discard(true);
+
+    bench_isr_canary_scan();
+    bench_formatting();
+    bench_dispatch();
+    bench_thread_report();
+
+    return 0;
+}
@@ -0,0 +1,281 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: RTT/SEGGER_RTT.c against an emulated debug probe, no J-Link
+ *          needed.
+ *
+ * The RTT control block and buffers are linked into a section of their own
+ * (rtt_shared.ld), which is remapped as shared memory before forking. The
+ * parent is the "target": it calls SEGGER_RTT_Write() as fast as it can.
+ * The child is the "probe": it polls WrOff, copies out what is new and
+ * advances RdOff, every poll interval, the way a J-Link does over SWD.
+ *
+ * For every mode, buffer size and poll interval there is one row:
+ *
+ *   benchmark  mode  buffer  poll_us  writes  bytes_per_s  drop_percent  p50_ns  p99_ns  max_ns
+ *
+ * bytes_per_s is what reached the probe, drop_percent what the target
+ * offered but RTT did not take, and the latencies are of single
+ * SEGGER_RTT_Write() calls. In the skip and blocking modes the probe also
+ * checks that it received whole messages in order, and the program fails
+ * if it did not.
+ *
+ * Run it on a machine with at least two cores. On one, the probe only gets
+ * to poll when the scheduler preempts the target, which says more about
+ * the scheduler than about RTT.
+ */
+
+#include <algorithm>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "RTT/SEGGER_RTT.h"
+
+#include "bench.h"
+
+extern "C" char rtt_shared_start[];
+extern "C" char rtt_shared_end[];
+
+enum
+{
+    BENCH_BUFFER     = 1,         // Buffer 0 has a fixed size.
+    BUFFER_SIZE_MAX  = 0x4000,
+    MESSAGE_SIZE     = 32,
+    LATENCIES_MAX    = 1 << 20
+};
+
+// Probe side, shared.
+typedef struct
+{
+    volatile uint32_t poll_us;
+    volatile uint32_t stop;
+    volatile uint32_t done;
+    volatile uint64_t bytes;
+    volatile uint32_t messages;
+    volatile uint32_t out_of_order;
+} probe_t;
+
+__attribute__((section("rtt_shared"))) static probe_t probe;
+__attribute__((section("rtt_shared"))) static char    rtt_buffer[BUFFER_SIZE_MAX];
+
+static void share_rtt_pages(void)
+{
+    size_t size = (size_t) (rtt_shared_end - rtt_shared_start);
+    char * copy = (char *) malloc(size);
+
+    memcpy(copy, rtt_shared_start, size);
+
+    if (mmap(rtt_shared_start, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != rtt_shared_start)
+    {
+        perror("mmap");
+        exit(1);
+    }
+
+    memcpy(rtt_shared_start, copy, size);
+    free(copy);
+}
+
+// Messages are a sequence number, then its low byte repeated.
+static void message_make(char * message, uint32_t sequence)
+{
+    memcpy(message, &sequence, sizeof(sequence));
+    memset(message + sizeof(sequence), (int) (sequence & 0xFF), MESSAGE_SIZE - sizeof(sequence));
+}
+
+static void probe_run(bool check)
+{
+    SEGGER_RTT_BUFFER_UP * up       = &_SEGGER_RTT.aUp[BENCH_BUFFER];
+    char                   message[MESSAGE_SIZE];
+    char                   expected[MESSAGE_SIZE];
+    uint32_t               filled   = 0;
+    uint32_t               next     = 0;
+
+    for (;;)
+    {
+        bool     stopping = probe.stop;
+        unsigned wr       = *(volatile unsigned *) &up->WrOff;
+        unsigned rd       = up->RdOff;
+
+        __sync_synchronize(); // Data before WrOff, as on the target.
+
+        while (rd != wr)
+        {
+            message[filled++] = up->pBuffer[rd];
+            rd = (rd + 1 == up->SizeOfBuffer) ? 0 : rd + 1;
+
+            probe.bytes++;
+
+            if (MESSAGE_SIZE == filled)
+            {
+                uint32_t sequence;
+
+                memcpy(&sequence, message, sizeof(sequence));
+                message_make(expected, sequence);
+
+                if (check && (sequence < next || memcmp(message, expected, MESSAGE_SIZE))) probe.out_of_order++;
+
+                next   = sequence + 1;
+                filled = 0;
+                probe.messages++;
+            }
+        }
+
+        __sync_synchronize();
+        up->RdOff = rd;
+
+        if (stopping) break;
+
+        if (probe.poll_us) usleep(probe.poll_us);
+        else               sched_yield();
+    }
+
+    probe.done = 1;
+}
+
+static const char * mode_name(unsigned mode)
+{
+    switch (mode)
+    {
+    case SEGGER_RTT_MODE_NO_BLOCK_SKIP:      return "skip";
+    case SEGGER_RTT_MODE_NO_BLOCK_TRIM:      return "trim";
+    case SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL: return "block";
+    }
+
+    return "?";
+}
+
+static uint64_t latencies[LATENCIES_MAX];
+
+static bool bench_rtt(unsigned mode, uint32_t buffer_size, uint32_t poll_us, uint64_t duration_ns)
+{
+    bool check = SEGGER_RTT_MODE_NO_BLOCK_TRIM != mode;
+
+    SEGGER_RTT_ConfigUpBuffer(BENCH_BUFFER, "bench", rtt_buffer, buffer_size, mode);
+    memset((void *) &probe, 0, sizeof(probe));
+    probe.poll_us = poll_us;
+
+    fflush(stdout);
+
+    pid_t child = fork();
+
+    if (child < 0)
+    {
+        perror("fork");
+        exit(1);
+    }
+
+    if (0 == child)
+    {
+        probe_run(check);
+        _exit(0);
+    }
+
+    char     message[MESSAGE_SIZE];
+    uint32_t writes  = 0;
+    uint64_t offered = 0;
+    uint64_t taken   = 0;
+    uint64_t start   = bench_ns();
+    uint64_t now     = start;
+
+    while (now - start < duration_ns && writes < LATENCIES_MAX)
+    {
+        message_make(message, writes);
+
+        unsigned written = SEGGER_RTT_Write(BENCH_BUFFER, message, MESSAGE_SIZE);
+        uint64_t after   = bench_ns();
+
+        latencies[writes++] = after - now;
+        offered            += MESSAGE_SIZE;
+        taken              += written;
+        now                 = after;
+    }
+
+    // Let the probe drain what is left, then stop it.
+    SEGGER_RTT_BUFFER_UP * up = &_SEGGER_RTT.aUp[BENCH_BUFFER];
+
+    while (up->RdOff != up->WrOff) sched_yield();
+
+    uint64_t elapsed = bench_ns() - start;
+
+    probe.stop = 1;
+    waitpid(child, NULL, 0);
+
+    std::sort(latencies, latencies + writes);
+
+    printf("rtt_write\t%s\t%u\t%u\t%u\t%.0f\t%.2f\t%llu\t%llu\t%llu\n",
+           mode_name(mode), buffer_size, poll_us, writes,
+           (double) probe.bytes * 1e9 / (double) elapsed,
+           100.0 * (double) (offered - taken) / (double) offered,
+           (unsigned long long) latencies[writes / 2],
+           (unsigned long long) latencies[(uint64_t) writes * 99 / 100],
+           (unsigned long long) latencies[writes - 1]);
+
+    if (probe.bytes != taken || probe.out_of_order)
+    {
+        fprintf(stderr, "rtt_write %s %u %u: %llu bytes taken, %llu received, %u messages out of order\n",
+                mode_name(mode), buffer_size, poll_us,
+                (unsigned long long) taken, (unsigned long long) probe.bytes, probe.out_of_order);
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char ** argv)
+{
+    static const unsigned MODES[]        = { SEGGER_RTT_MODE_NO_BLOCK_SKIP, SEGGER_RTT_MODE_NO_BLOCK_TRIM, SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL };
+    static const uint32_t BUFFER_SIZES[] = { 256, 1024, 4096, BUFFER_SIZE_MAX };
+    static const uint32_t POLL_US[]      = { 0, 100, 1000 };
+
+    bench_options(argc, argv);
+
+    // Before anything touches RTT, so the initialized control block is
+    // what both processes share.
+    share_rtt_pages();
+    SEGGER_RTT_Init();
+
+    uint64_t duration_ns = bench_quick ? 2000000 : 50000000;
+    bool     ok          = true;
+
+    printf("benchmark\tmode\tbuffer\tpoll_us\twrites\tbytes_per_s\tdrop_percent\tp50_ns\tp99_ns\tmax_ns\n");
+
+    for (uint32_t m = 0; m < sizeof(MODES) / sizeof(MODES[0]); m++)
+    {
+        for (uint32_t b = 0; b < sizeof(BUFFER_SIZES) / sizeof(BUFFER_SIZES[0]); b++)
+        {
+            for (uint32_t p = 0; p < sizeof(POLL_US) / sizeof(POLL_US[0]); p++)
+            {
+                if (!bench_rtt(MODES[m], BUFFER_SIZES[b], POLL_US[p], duration_ns)) ok = false;
+            }
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Host stand-in for the CMSIS core intrinsics and registers the
+ *          library touches.
+ */
+
+#ifndef HOST_CMSIS_H
+#define HOST_CMSIS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern uint32_t SystemCoreClock;
+
+// Process stack pointer of the interrupted thread, as an exception handler
+// sees it: points at the exception frame host_set_exception_pc() wrote.
+uint32_t __get_PSP(void);
+
+// Active exception number: 0 in thread mode, see host_set_ipsr().
+uint32_t __get_IPSR(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define __CLZ(x)  ((uint32_t) ((x) ? __builtin_clz(x) : 32))
+
+#ifdef __cplusplus
+// The DWT cycle counter, as far as the library uses it. CYCCNT reads the
+// virtual clock (see host_clock_advance() in host_target.h), truncated to
+// 32 bits like the real one, once both enable bits below are set, and 0
+// before that.
+
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+
+struct host_cyccnt_t
+{
+    operator uint32_t() const volatile;
+};
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    host_cyccnt_t     CYCCNT;
+} host_dwt_t;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} host_core_debug_t;
+
+extern host_dwt_t        host_dwt;
+extern host_core_debug_t host_core_debug;
+
+#define DWT        (&host_dwt)
+#define CoreDebug  (&host_core_debug)
+#endif
+
+#endif /* HOST_CMSIS_H */
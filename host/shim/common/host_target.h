@@ -0,0 +1,160 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: The host side of the shims. Tests and benchmarks set up what
+ *          mbed_memory_status.cpp is going to read through here, and get
+ *          back what it wrote.
+ *
+ * Everything the library treats as a target address (TCBs, stacks, the
+ * ISR stack, exception frames) lives in a fixed mapping at HOST_RAM_BASE,
+ * below 4 GB, so the library's 32-bit pointer arithmetic is exact on a
+ * 64-bit host and addresses in the output are the same on every run.
+ */
+
+#ifndef HOST_TARGET_H
+#define HOST_TARGET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform/mbed_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+    HOST_RAM_BASE      = 0x20000000,
+    HOST_RAM_SIZE      = 0x00100000,
+
+    // Where the synthetic ISR stack lives. The linker symbols
+    // __StackLimit / __StackTop are set to match (see CMakeLists.txt).
+    HOST_ISR_STACK_TOP  = HOST_RAM_BASE + HOST_RAM_SIZE,
+    HOST_ISR_STACK_SIZE = 0x800,
+
+    // Reported heap region; the host's own malloc() is used for real.
+    HOST_HEAP_START    = 0x200E0000,
+    HOST_HEAP_SIZE     = 0x00010000,
+
+    HOST_MAX_THREADS   = 64
+};
+
+// Resets all host state: threads, output, clock, heap statistics, locks.
+// Called once before main(); call again between independent test cases.
+void host_reset(void);
+
+// Output. Everything written to the serial port since the last clear.
+// With discard set, bytes are counted but not kept (for benchmarks).
+void         host_output_clear(void);
+const char * host_output(void);
+uint32_t     host_output_length(void);
+void         host_output_discard(bool discard);
+
+// Clock. Virtual: only moves when told to, and by the serial port, which
+// costs host_serial_cycles_per_byte per byte written (0 by default).
+// us_ticker_read() and osKernelGetTickCount() are derived from it.
+void     host_clock_advance(uint32_t cycles);
+uint64_t host_clock_cycles(void);
+
+extern uint32_t          host_serial_cycles_per_byte;
+
+// What mbed_stats_heap_get() returns.
+extern mbed_stats_heap_t host_heap_stats;
+
+// Called by every shimmed RTOS function that is an SVC on the target. An
+// SVC with interrupts masked escalates to HardFault, so inside a critical
+// section this prints the offending call and aborts the program.
+void host_svc(const char * function);
+
+int  host_critical_depth(void);
+int  host_kernel_lock_depth(void);
+
+// Number of osKernelLock() calls so far.
+uint32_t host_kernel_lock_count(void);
+
+// Synthetic threads. Stacks are filled with the RTOS fill pattern except
+// for the top stack_used bytes, so the RTOS' own high-water mark scan
+// finds exactly stack_used.
+typedef struct
+{
+    const char * name;          // Ignored on CMSIS-RTOS 1.
+    uint32_t     entry;
+    uint32_t     stack_size;
+    uint32_t     stack_used;
+    int32_t      priority;      // 0 for the RTOS' normal priority.
+    bool         os_stack;      // CMSIS-RTOS 1: stack from the OS pool (priv_stack == 0).
+} host_thread_config_t;
+
+// Threads are laid out in creation order. An exited thread's TCB is reused
+// by the next thread created, as the RTOS would. On CMSIS-RTOS 2, exiting
+// fires the RTOS thread destroyed event.
+void * host_thread_create(const host_thread_config_t * config);
+void   host_thread_exit(void * thread);
+
+// thread becomes the running one: osThreadGetId() returns it, and the
+// RTOS thread switch event fires.
+void   host_thread_switch(void * thread);
+
+// Moves thread to the delay (or wait) list, or back to ready. Making a
+// thread ready fires the RTOS unblocked event.
+void   host_thread_block(void * thread, bool delay);
+void   host_thread_ready(void * thread);
+
+// Saved SP, as stack bytes in use (0 is an empty stack).
+void   host_thread_set_depth(void * thread, uint32_t depth);
+
+// CMSIS-RTOS 2 mutexes and semaphores: the next acquire of object that
+// does not wait fails with osErrorResource, and one that waits gets it
+// after cycles. Models another thread holding it for that long.
+void   host_object_contend(void * object, uint32_t cycles);
+
+// Same, but the waiting acquire then gives up with osErrorTimeout.
+void   host_object_time_out(void * object, uint32_t cycles);
+
+// Writes the exception frame __get_PSP() points at, with this PC.
+void   host_set_exception_pc(uint32_t pc);
+
+// What __get_IPSR() returns: 0 in thread mode, an exception number while
+// the test is standing in for an interrupt handler.
+void   host_set_ipsr(uint32_t ipsr);
+
+// Calls every attached Ticker callback once.
+void   host_ticker_fire(void);
+
+// Calls the mbed memory trace callback, if one is set, the way mbed's
+// allocation wrappers would after the allocation.
+void   host_trace_malloc(void * result, uint32_t size, void * caller);
+void   host_trace_realloc(void * result, void * ptr, uint32_t size, void * caller);
+void   host_trace_calloc(void * result, uint32_t count, uint32_t size, void * caller);
+void   host_trace_free(void * ptr, void * caller);
+
+// A pointer to the target address, for tests that poke at target memory.
+void * host_ram(uint32_t address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TARGET_H */
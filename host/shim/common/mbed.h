@@ -0,0 +1,69 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Host stand-in for mbed.h, for building mbed_memory_status.cpp
+ *          on Linux (see host/CMakeLists.txt). Only what the library uses.
+ */
+
+#ifndef HOST_MBED_H
+#define HOST_MBED_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cmsis.h"
+
+// Set per build in CMakeLists.txt: 5.4.7 for CMSIS-RTOS 1, 5.9.5 otherwise.
+#ifndef MBED_VERSION
+#define MBED_VERSION   50905
+#endif
+
+#define DEVICE_SERIAL  1
+#define STDIO_UART_TX  0
+#define STDIO_UART_RX  0
+
+#ifdef __cplusplus
+// Never fires on its own. host_ticker_fire() calls every attached
+// callback once, as if its interval had elapsed.
+class Ticker
+{
+public:
+    Ticker();
+    ~Ticker();
+
+    void attach_us(void (*func)(void), uint32_t us);
+    void detach(void);
+
+    void     (*func)(void);
+    uint32_t interval_us;
+    Ticker   *next;
+
+private:
+    Ticker(const Ticker &);
+    Ticker & operator=(const Ticker &);
+};
+#endif
+
+#endif /* HOST_MBED_H */
@@ -0,0 +1,90 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Host stand-in for mbed OS 5.4 cmsis_os.h (CMSIS-RTOS 1 on RTX4),
+ *          backed by the synthetic thread table in host_rtx4.cpp.
+ */
+
+#ifndef HOST_CMSIS_OS_H
+#define HOST_CMSIS_OS_H
+
+#include <stdint.h>
+
+#define osCMSIS  0x10002U
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    osOK               = 0,
+    osEventSignal      = 0x08,
+    osEventMessage     = 0x10,
+    osEventMail        = 0x20,
+    osEventTimeout     = 0x40,
+    osErrorParameter   = 0x80,
+    osErrorResource    = 0x81,
+    osErrorTimeoutResource = 0xC1,
+    osErrorISR         = 0x82,
+    osErrorValue       = 0x86,
+    osErrorOS          = 0xFF
+} osStatus;
+
+typedef enum
+{
+    osThreadInfoState,
+    osThreadInfoStackSize,
+    osThreadInfoStackMax,
+    osThreadInfoEntry,
+    osThreadInfoArg
+} osThreadInfo;
+
+typedef struct os_thread_cb * osThreadId;
+typedef void                * osThreadEnumId;
+
+typedef struct
+{
+    osStatus status;
+
+    union
+    {
+        uint32_t v;
+        void   * p;
+        int32_t  signals;
+    } value;
+} osEvent;
+
+// All of these are SVCs on the target (see host_svc() in host_target.h).
+osThreadId     osThreadGetId(void);
+osEvent        _osThreadGetInfo(osThreadId thread_id, osThreadInfo info);
+osThreadEnumId _osThreadsEnumStart(void);
+osThreadId     _osThreadEnumNext(osThreadEnumId enum_id);
+osStatus       _osThreadEnumFree(osThreadEnumId enum_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_CMSIS_OS_H */
@@ -0,0 +1,74 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Host stand-in for RTX4's rt_TypeDef.h, task control block as in
+ *          mbed OS 5.4.
+ */
+
+#ifndef HOST_RT_TYPEDEF_H
+#define HOST_RT_TYPEDEF_H
+
+#include <stdint.h>
+
+typedef uint8_t  U8;
+typedef uint16_t U16;
+typedef uint32_t U32;
+
+typedef void (*FUNCP)(void);
+
+#ifndef NULL
+ #ifdef __cplusplus
+  #define NULL  0
+ #else
+  #define NULL  ((void *) 0)
+ #endif
+#endif
+
+typedef struct OS_TCB
+{
+    U8             cb_type;
+    U8             state;
+    U8             prio;
+    U8             task_id;
+    struct OS_TCB *p_lnk;
+    struct OS_TCB *p_rlnk;
+    struct OS_TCB *p_dlnk;
+    struct OS_TCB *p_blnk;
+    U16            delta_time;
+    U16            interval_time;
+    U16            events;
+    U16            waits;
+    void         **msg;
+    void          *p_mlnk;
+    U8             prio_base;
+    U8             ret_val;
+    U8             ret_upd;
+    U32            priv_stack;  // Private stack size, 0 = from the OS pool.
+    U32            tsk_stack;
+    U32           *stack;
+    FUNCP          ptask;
+    void          *context;
+} *P_TCB;
+
+#endif /* HOST_RT_TYPEDEF_H */
@@ -0,0 +1,122 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Host stand-in for the CMSIS-RTOS 2 API, backed by the synthetic
+ *          thread table in host_rtx5.cpp.
+ */
+
+#ifndef HOST_CMSIS_OS2_H
+#define HOST_CMSIS_OS2_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    osOK             =  0,
+    osError          = -1,
+    osErrorTimeout   = -2,
+    osErrorResource  = -3,
+    osErrorParameter = -4,
+    osErrorNoMemory  = -5,
+    osErrorISR       = -6
+} osStatus_t;
+
+typedef enum
+{
+    osThreadInactive   =  0,
+    osThreadReady      =  1,
+    osThreadRunning    =  2,
+    osThreadBlocked    =  3,
+    osThreadTerminated =  4,
+    osThreadError      = -1
+} osThreadState_t;
+
+typedef enum
+{
+    osPriorityNone     =  0,
+    osPriorityIdle     =  1,
+    osPriorityLow      =  8,
+    osPriorityNormal   = 24,
+    osPriorityHigh     = 40,
+    osPriorityRealtime = 48,
+    osPriorityISR      = 56,
+    osPriorityError    = -1
+} osPriority_t;
+
+typedef void * osThreadId_t;
+typedef void * osMutexId_t;
+typedef void * osSemaphoreId_t;
+
+#define osWaitForever  0xFFFFFFFFU
+
+typedef struct
+{
+    const char * name;
+    uint32_t     attr_bits;
+    void       * cb_mem;
+    uint32_t     cb_size;
+} osMutexAttr_t;
+
+typedef struct
+{
+    const char * name;
+    uint32_t     attr_bits;
+    void       * cb_mem;
+    uint32_t     cb_size;
+} osSemaphoreAttr_t;
+
+int32_t         osKernelLock(void);
+int32_t         osKernelUnlock(void);
+uint32_t        osKernelGetTickCount(void);
+
+osThreadId_t    osThreadGetId(void);
+const char    * osThreadGetName(osThreadId_t thread_id);
+osThreadState_t osThreadGetState(osThreadId_t thread_id);
+osPriority_t    osThreadGetPriority(osThreadId_t thread_id);
+uint32_t        osThreadGetStackSize(osThreadId_t thread_id);
+uint32_t        osThreadGetStackSpace(osThreadId_t thread_id);
+uint32_t        osThreadGetCount(void);
+uint32_t        osThreadEnumerate(osThreadId_t * thread_array, uint32_t array_items);
+
+osMutexId_t     osMutexNew(const osMutexAttr_t * attr);
+const char    * osMutexGetName(osMutexId_t mutex_id);
+osStatus_t      osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout);
+osStatus_t      osMutexRelease(osMutexId_t mutex_id);
+osStatus_t      osMutexDelete(osMutexId_t mutex_id);
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t * attr);
+const char    * osSemaphoreGetName(osSemaphoreId_t semaphore_id);
+osStatus_t      osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout);
+osStatus_t      osSemaphoreRelease(osSemaphoreId_t semaphore_id);
+osStatus_t      osSemaphoreDelete(osSemaphoreId_t semaphore_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_CMSIS_OS2_H */
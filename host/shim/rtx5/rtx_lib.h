@@ -0,0 +1,146 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Host stand-in for the parts of RTX5's rtx_lib.h / rtx_os.h the
+ *          library reads directly. Layouts follow RTX 5.x as shipped with
+ *          mbed OS 5.5 to 5.9.
+ */
+
+#ifndef HOST_RTX_LIB_H
+#define HOST_RTX_LIB_H
+
+#include <stdint.h>
+
+#include "cmsis_os2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define osRtxIdThread              0xF1U
+
+#define osRtxStackMagicWord        0xE25A2EA5U
+#define osRtxStackFillPattern      0xCCCCCCCCU
+
+#define osRtxConfigStackWatermark  (1UL << 1)
+
+typedef struct osRtxThread_s
+{
+    uint8_t                id;
+    uint8_t                state;
+    uint8_t                flags;
+    uint8_t                attr;
+    const char           * name;
+    struct osRtxThread_s * thread_next;
+    struct osRtxThread_s * thread_prev;
+    struct osRtxThread_s * delay_next;
+    struct osRtxThread_s * delay_prev;
+    struct osRtxThread_s * thread_join;
+    uint32_t               delay;
+    int8_t                 priority;
+    int8_t                 priority_base;
+    uint8_t                stack_frame;
+    uint8_t                flags_options;
+    uint32_t               wait_flags;
+    uint32_t               thread_flags;
+    void                 * mutex_list;
+    void                 * stack_mem;
+    uint32_t               stack_size;
+    uint32_t               sp;
+    uint32_t               thread_addr;
+    uint32_t               tz_memory;
+} osRtxThread_t;
+
+#define os_thread_t  osRtxThread_t
+
+typedef struct
+{
+    uint8_t         id;
+    uint8_t         reserved;
+    uint16_t        reserved2;
+    osRtxThread_t * thread_list;
+} osRtxObjectList_t;
+
+typedef struct
+{
+    const char * os_id;
+    uint32_t     version;
+
+    struct
+    {
+        uint8_t  state;
+        volatile uint8_t blocked;
+        uint8_t  pendSV;
+        uint8_t  reserved;
+        uint32_t tick;
+    } kernel;
+
+    int32_t tick_irqn;
+
+    struct
+    {
+        struct
+        {
+            osRtxThread_t * curr;
+            osRtxThread_t * next;
+        } run;
+
+        osRtxObjectList_t ready;
+        osRtxThread_t   * idle;
+        osRtxThread_t   * delay_list;
+        osRtxThread_t   * wait_list;
+        osRtxThread_t   * terminate_list;
+    } thread;
+} osRtxInfo_t;
+
+extern osRtxInfo_t osRtxInfo;
+
+typedef struct
+{
+    uint32_t flags;
+} osRtxConfig_t;
+
+extern const osRtxConfig_t osRtxConfig;
+
+// RTX_Config.h's default, and what rtx_evr.h makes of it: with thread
+// events off, the hooks are empty macros.
+#ifndef OS_EVR_THREAD
+#define OS_EVR_THREAD  1
+#endif
+
+#if !defined (EVR_RTX_DISABLE) && (OS_EVR_THREAD != 0)
+void EvrRtxThreadSwitched(osThreadId_t thread_id);
+void EvrRtxThreadUnblocked(osThreadId_t thread_id, uint32_t ret_val);
+void EvrRtxThreadDestroyed(osThreadId_t thread_id);
+#else
+#define EvrRtxThreadSwitched(thread_id)
+#define EvrRtxThreadUnblocked(thread_id, ret_val)
+#define EvrRtxThreadDestroyed(thread_id)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_RTX_LIB_H */
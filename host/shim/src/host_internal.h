@@ -0,0 +1,61 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Shared between host_target.cpp and the RTOS backends
+ *          (host_rtx4.cpp, host_rtx5.cpp, host_no_rtos.cpp).
+ */
+
+#ifndef HOST_INTERNAL_H
+#define HOST_INTERNAL_H
+
+#include <stdint.h>
+
+#include "host_target.h"
+
+#define HOST_ADDRESS(pointer)  ((uint32_t) (uintptr_t) (pointer))
+#define HOST_POINTER(address)  ((void *) (uintptr_t) (address))
+
+enum
+{
+    // Target RAM layout, below the ISR stack and heap region.
+    HOST_TCB_BASE         = HOST_RAM_BASE + 0x100,
+    HOST_TCB_STRIDE       = 0x80,
+    HOST_STACK_BASE       = HOST_TCB_BASE + HOST_MAX_THREADS * HOST_TCB_STRIDE,
+    HOST_STACK_LIMIT      = HOST_RAM_BASE + 0xD0000,
+    HOST_OBJECT_BASE      = HOST_STACK_LIMIT,          // Mutexes, semaphores.
+    HOST_EXCEPTION_FRAME  = HOST_HEAP_START - 0x100
+};
+
+// Implemented by the RTOS backend.
+void host_rtos_reset(void);
+
+// osKernelLock() / osKernelUnlock(), counted for host_kernel_lock_count().
+// Return the previous lock state.
+int32_t host_kernel_lock(void);
+int32_t host_kernel_unlock(void);
+
+// Bump allocator over [HOST_STACK_BASE, HOST_STACK_LIMIT), 8-byte aligned.
+uint32_t host_stack_alloc(uint32_t size);
+
+#endif /* HOST_INTERNAL_H */
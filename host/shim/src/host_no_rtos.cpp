@@ -0,0 +1,56 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Builds without an RTOS. There are no threads to set up.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_internal.h"
+
+void host_rtos_reset(void)
+{
+}
+
+static void host_no_threads(void)
+{
+    fprintf(stderr, "host: no threads without an RTOS\n");
+    abort();
+}
+
+void * host_thread_create(const host_thread_config_t * config)
+{
+    (void) config;
+
+    host_no_threads();
+    return NULL;
+}
+
+void host_thread_exit(void *)              { host_no_threads(); }
+void host_thread_switch(void *)            { host_no_threads(); }
+void host_thread_block(void *, bool)       { host_no_threads(); }
+void host_thread_ready(void *)             { host_no_threads(); }
+void host_thread_set_depth(void *, uint32_t) { host_no_threads(); }
+void host_object_contend(void *, uint32_t) { host_no_threads(); }
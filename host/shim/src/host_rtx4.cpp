@@ -0,0 +1,303 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: CMSIS-RTOS 1 on RTX4, as far as the library sees it: TCBs and
+ *          stacks in target RAM, and the SVC calls that read them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmsis_os.h"
+#include "rt_TypeDef.h"
+
+#include "host_internal.h"
+
+// rt_Task.h / rt_Typedef.h
+enum
+{
+    HOST_TCB_TASK   = 0,
+    HOST_INACTIVE   = 0,
+    HOST_READY      = 1,
+    HOST_RUNNING    = 2,
+    HOST_WAIT_DLY   = 3,
+    HOST_WAIT_OR    = 5,
+
+    HOST_MAGIC_WORD    = 0xE25A2EA5,
+    HOST_MAGIC_PATTERN = 0xCCCCCCCC
+};
+
+// RTX_Conf_CM.c: OS_STKINIT set, so private stacks are filled.
+extern "C" const uint32_t os_stackinfo = (1U << 28);
+
+static bool     host_tcb_used[HOST_MAX_THREADS];
+static uint32_t host_os_stack_size[HOST_MAX_THREADS]; // priv_stack == 0 only.
+static P_TCB    host_running = NULL;
+
+static P_TCB host_tcb(uint32_t index)
+{
+    return (P_TCB) host_ram(HOST_TCB_BASE + index * HOST_TCB_STRIDE);
+}
+
+static uint32_t host_index(osThreadId thread_id)
+{
+    uint32_t address = HOST_ADDRESS(thread_id);
+    uint32_t index   = (address - HOST_TCB_BASE) / HOST_TCB_STRIDE;
+
+    if (address < HOST_TCB_BASE || index >= HOST_MAX_THREADS || !host_tcb_used[index])
+    {
+        fprintf(stderr, "host: %p is not a thread\n", (void *) thread_id);
+        abort();
+    }
+
+    return index;
+}
+
+extern "C" P_TCB rt_tid2ptcb(osThreadId thread_id)
+{
+    return host_tcb(host_index(thread_id));
+}
+
+// Control
+
+void host_rtos_reset(void)
+{
+    memset(host_tcb_used, 0, sizeof(host_tcb_used));
+    memset(host_os_stack_size, 0, sizeof(host_os_stack_size));
+
+    host_running = NULL;
+}
+
+void * host_thread_create(const host_thread_config_t * config)
+{
+    uint32_t index = 0;
+
+    while (index < HOST_MAX_THREADS && host_tcb_used[index]) index++;
+
+    if (index == HOST_MAX_THREADS || config->stack_size < 8 || config->stack_used > config->stack_size)
+    {
+        fprintf(stderr, "host: cannot create thread\n");
+        abort();
+    }
+
+    uint32_t   stack_size = config->stack_size & ~7U;
+    uint32_t   stack_mem  = host_stack_alloc(stack_size);
+    uint32_t * stack      = (uint32_t *) host_ram(stack_mem);
+    uint32_t   words      = stack_size / 4;
+    uint32_t   untouched  = (stack_size - config->stack_used) / 4;
+    P_TCB      tcb        = host_tcb(index);
+
+    stack[0] = HOST_MAGIC_WORD;
+
+    for (uint32_t i = 1; i < words; i++)
+    {
+        stack[i] = (i < untouched) ? (uint32_t) HOST_MAGIC_PATTERN : 0;
+    }
+
+    memset(tcb, 0, sizeof(*tcb));
+
+    tcb->cb_type    = HOST_TCB_TASK;
+    tcb->state      = HOST_READY;
+    tcb->prio       = (U8) (config->priority + 3); // osPriorityNormal (0) is 3.
+    tcb->prio_base  = tcb->prio;
+    tcb->task_id    = (U8) (index + 1);
+    tcb->priv_stack = config->os_stack ? 0 : stack_size;
+    tcb->stack      = stack;
+    tcb->tsk_stack  = stack_mem + stack_size;
+    tcb->ptask      = (FUNCP) (uintptr_t) config->entry;
+
+    host_tcb_used[index]      = true;
+    host_os_stack_size[index] = stack_size;
+
+    return tcb;
+}
+
+void host_thread_exit(void * thread)
+{
+    uint32_t index = host_index((osThreadId) thread);
+
+    if (host_running == host_tcb(index)) host_running = NULL;
+
+    host_tcb(index)->state = HOST_INACTIVE;
+    host_tcb_used[index]   = false;
+}
+
+void host_thread_switch(void * thread)
+{
+    P_TCB tcb = host_tcb(host_index((osThreadId) thread));
+
+    if (host_running && host_running != tcb) host_running->state = HOST_READY;
+
+    tcb->state   = HOST_RUNNING;
+    host_running = tcb;
+}
+
+void host_thread_block(void * thread, bool delay)
+{
+    P_TCB tcb = host_tcb(host_index((osThreadId) thread));
+
+    if (host_running == tcb) host_running = NULL;
+
+    tcb->state = delay ? HOST_WAIT_DLY : HOST_WAIT_OR;
+}
+
+void host_thread_ready(void * thread)
+{
+    P_TCB tcb = host_tcb(host_index((osThreadId) thread));
+
+    if (host_running == tcb) host_running = NULL;
+
+    tcb->state = HOST_READY;
+}
+
+void host_thread_set_depth(void * thread, uint32_t depth)
+{
+    P_TCB tcb = host_tcb(host_index((osThreadId) thread));
+
+    tcb->tsk_stack = HOST_ADDRESS(tcb->stack) + host_os_stack_size[host_index((osThreadId) thread)] - depth;
+}
+
+// SVCs
+
+osThreadId osThreadGetId(void)
+{
+    host_svc("osThreadGetId");
+
+    return (osThreadId) host_running;
+}
+
+// Refs: rt_CMSIS.c - svcThreadGetInfo()
+osEvent _osThreadGetInfo(osThreadId thread_id, osThreadInfo info)
+{
+    host_svc("_osThreadGetInfo");
+
+    uint32_t index = host_index(thread_id);
+    P_TCB    tcb   = host_tcb(index);
+    osEvent  event;
+
+    memset(&event, 0, sizeof(event));
+    event.status = osOK;
+
+    switch (info)
+    {
+    case osThreadInfoState:
+        event.value.v = tcb->state;
+        break;
+
+    case osThreadInfoStackSize:
+        event.value.v = tcb->priv_stack ? tcb->priv_stack : host_os_stack_size[index];
+        break;
+
+    case osThreadInfoStackMax:
+    {
+        uint32_t size = tcb->priv_stack ? tcb->priv_stack : host_os_stack_size[index];
+        uint32_t i;
+
+        for (i = 1; i < size / 4; i++)
+        {
+            if (tcb->stack[i] != HOST_MAGIC_PATTERN) break;
+        }
+
+        event.value.v = size - i * 4;
+        break;
+    }
+
+    case osThreadInfoEntry:
+        event.value.p = (void *) tcb->ptask;
+        break;
+
+    default:
+        event.status = osErrorValue;
+        break;
+    }
+
+    return event;
+}
+
+// Enumerates in TCB order, like the real one walks os_active_TCB[].
+typedef struct
+{
+    uint32_t next;
+    bool     used;
+} host_enum_t;
+
+static host_enum_t host_enums[4];
+
+osThreadEnumId _osThreadsEnumStart(void)
+{
+    host_svc("_osThreadsEnumStart");
+
+    for (uint32_t i = 0; i < sizeof(host_enums) / sizeof(host_enums[0]); i++)
+    {
+        if (!host_enums[i].used)
+        {
+            host_enums[i].used = true;
+            host_enums[i].next = 0;
+            return &host_enums[i];
+        }
+    }
+
+    return NULL;
+}
+
+osThreadId _osThreadEnumNext(osThreadEnumId enum_id)
+{
+    host_svc("_osThreadEnumNext");
+
+    host_enum_t * iterator = (host_enum_t *) enum_id;
+
+    if (!iterator) return NULL;
+
+    while (iterator->next < HOST_MAX_THREADS)
+    {
+        uint32_t index = iterator->next++;
+
+        if (host_tcb_used[index]) return (osThreadId) host_tcb(index);
+    }
+
+    return NULL;
+}
+
+osStatus _osThreadEnumFree(osThreadEnumId enum_id)
+{
+    host_svc("_osThreadEnumFree");
+
+    host_enum_t * iterator = (host_enum_t *) enum_id;
+
+    if (!iterator) return osErrorParameter;
+
+    iterator->used = false;
+
+    return osOK;
+}
+
+void host_object_contend(void * object, uint32_t cycles)
+{
+    (void) object;
+    (void) cycles;
+
+    fprintf(stderr, "host: no mutex contention on CMSIS-RTOS 1\n");
+    abort();
+}
@@ -0,0 +1,537 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: CMSIS-RTOS 2 on RTX5, as far as the library sees it: TCBs,
+ *          stacks and thread lists in target RAM, laid out and linked the
+ *          way RTX5 does, and the API calls that read them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmsis.h"
+#include "cmsis_os2.h"
+#include "rtx_lib.h"
+
+#include "host_internal.h"
+
+// Internal RTX5 thread states (rtx_os.h); the API reports the low nibble.
+enum
+{
+    HOST_RTX_INACTIVE      = 0x00,
+    HOST_RTX_READY         = 0x01,
+    HOST_RTX_RUNNING       = 0x02,
+    HOST_RTX_BLOCKED       = 0x03,
+    HOST_RTX_BLOCKED_DELAY = 0x13
+};
+
+osRtxInfo_t         osRtxInfo;
+const osRtxConfig_t osRtxConfig = { osRtxConfigStackWatermark };
+
+// Defaults for the event hooks, as in rtx_evr.c. The library's own replace
+// them when it is built with the features that use them.
+#if !defined (EVR_RTX_DISABLE) && (OS_EVR_THREAD != 0)
+extern "C" __attribute__((weak)) void EvrRtxThreadSwitched(osThreadId_t thread_id)
+{
+    (void) thread_id;
+}
+
+extern "C" __attribute__((weak)) void EvrRtxThreadUnblocked(osThreadId_t thread_id, uint32_t ret_val)
+{
+    (void) thread_id;
+    (void) ret_val;
+}
+
+extern "C" __attribute__((weak)) void EvrRtxThreadDestroyed(osThreadId_t thread_id)
+{
+    (void) thread_id;
+}
+#endif
+
+static osRtxThread_t * host_tcb(uint32_t index)
+{
+    return (osRtxThread_t *) host_ram(HOST_TCB_BASE + index * HOST_TCB_STRIDE);
+}
+
+static osRtxThread_t * host_thread(void * thread)
+{
+    osRtxThread_t * tcb = (osRtxThread_t *) thread;
+
+    if (!tcb || tcb->id != osRtxIdThread)
+    {
+        fprintf(stderr, "host: %p is not a thread\n", thread);
+        abort();
+    }
+
+    return tcb;
+}
+
+// Thread lists
+
+static void host_list_remove(osRtxThread_t * tcb)
+{
+    if (osRtxInfo.thread.run.curr == tcb)
+    {
+        osRtxInfo.thread.run.curr = NULL;
+        return;
+    }
+
+    osRtxThread_t ** link;
+
+    if (HOST_RTX_READY == tcb->state)
+    {
+        link = &osRtxInfo.thread.ready.thread_list;
+
+        while (*link && *link != tcb) link = &(*link)->thread_next;
+
+        if (*link) *link = tcb->thread_next;
+    }
+    else if (HOST_RTX_BLOCKED_DELAY == tcb->state || HOST_RTX_BLOCKED == tcb->state)
+    {
+        link = (HOST_RTX_BLOCKED_DELAY == tcb->state) ? &osRtxInfo.thread.delay_list : &osRtxInfo.thread.wait_list;
+
+        while (*link && *link != tcb) link = &(*link)->delay_next;
+
+        if (*link) *link = tcb->delay_next;
+    }
+
+    tcb->thread_next = NULL;
+    tcb->thread_prev = NULL;
+    tcb->delay_next  = NULL;
+    tcb->delay_prev  = NULL;
+}
+
+// Ready list is kept in priority order, highest first, FIFO within one.
+static void host_list_ready(osRtxThread_t * tcb)
+{
+    osRtxThread_t ** link = &osRtxInfo.thread.ready.thread_list;
+    osRtxThread_t  * prev = NULL;
+
+    while (*link && (*link)->priority >= tcb->priority)
+    {
+        prev = *link;
+        link = &(*link)->thread_next;
+    }
+
+    tcb->thread_next = *link;
+    tcb->thread_prev = prev;
+
+    if (*link) (*link)->thread_prev = tcb;
+
+    *link      = tcb;
+    tcb->state = HOST_RTX_READY;
+}
+
+static void host_list_block(osRtxThread_t * tcb, bool delay)
+{
+    osRtxThread_t ** link = delay ? &osRtxInfo.thread.delay_list : &osRtxInfo.thread.wait_list;
+    osRtxThread_t  * prev = NULL;
+
+    while (*link)
+    {
+        prev = *link;
+        link = &(*link)->delay_next;
+    }
+
+    tcb->delay_prev = prev;
+    *link           = tcb;
+    tcb->state      = delay ? HOST_RTX_BLOCKED_DELAY : HOST_RTX_BLOCKED;
+}
+
+// Control
+
+void host_rtos_reset(void)
+{
+    memset(&osRtxInfo, 0, sizeof(osRtxInfo));
+
+    osRtxInfo.os_id   = "RTX V5.x (host)";
+    osRtxInfo.version = 50000000;
+}
+
+void * host_thread_create(const host_thread_config_t * config)
+{
+    osRtxThread_t * tcb = NULL;
+
+    for (uint32_t i = 0; i < HOST_MAX_THREADS && !tcb; i++)
+    {
+        if (host_tcb(i)->id != osRtxIdThread) tcb = host_tcb(i);
+    }
+
+    if (!tcb || config->stack_size < 8 || config->stack_used > config->stack_size)
+    {
+        fprintf(stderr, "host: cannot create thread %s\n", config->name ? config->name : "(unnamed)");
+        abort();
+    }
+
+    uint32_t   stack_size = config->stack_size & ~7U;
+    uint32_t   stack_mem  = host_stack_alloc(stack_size);
+    uint32_t * stack      = (uint32_t *) host_ram(stack_mem);
+    uint32_t   words      = stack_size / 4;
+    uint32_t   untouched  = (stack_size - config->stack_used) / 4;
+
+    stack[0] = osRtxStackMagicWord;
+
+    for (uint32_t i = 1; i < words; i++)
+    {
+        stack[i] = (i < untouched) ? osRtxStackFillPattern : 0;
+    }
+
+    memset(tcb, 0, sizeof(*tcb));
+
+    tcb->id            = osRtxIdThread;
+    tcb->name          = config->name;
+    tcb->priority      = (int8_t) (config->priority ? config->priority : osPriorityNormal);
+    tcb->priority_base = tcb->priority;
+    tcb->stack_mem     = HOST_POINTER(stack_mem);
+    tcb->stack_size    = stack_size;
+    tcb->sp            = stack_mem + stack_size;
+    tcb->thread_addr   = config->entry;
+
+    host_list_ready(tcb);
+
+    return tcb;
+}
+
+void host_thread_exit(void * thread)
+{
+    osRtxThread_t * tcb = host_thread(thread);
+
+    host_list_remove(tcb);
+
+    tcb->id    = 0;
+    tcb->state = HOST_RTX_INACTIVE;
+
+    EvrRtxThreadDestroyed(tcb);
+}
+
+void host_thread_switch(void * thread)
+{
+    osRtxThread_t * tcb  = host_thread(thread);
+    osRtxThread_t * curr = osRtxInfo.thread.run.curr;
+
+    if (curr == tcb) return;
+
+    if (curr) host_list_ready(curr);
+
+    host_list_remove(tcb);
+
+    tcb->state                = HOST_RTX_RUNNING;
+    osRtxInfo.thread.run.curr = tcb;
+    osRtxInfo.thread.run.next = tcb;
+
+    EvrRtxThreadSwitched(tcb);
+}
+
+void host_thread_block(void * thread, bool delay)
+{
+    osRtxThread_t * tcb = host_thread(thread);
+
+    host_list_remove(tcb);
+    host_list_block(tcb, delay);
+}
+
+void host_thread_ready(void * thread)
+{
+    osRtxThread_t * tcb = host_thread(thread);
+
+    host_list_remove(tcb);
+    host_list_ready(tcb);
+
+    EvrRtxThreadUnblocked(tcb, 0);
+}
+
+void host_thread_set_depth(void * thread, uint32_t depth)
+{
+    osRtxThread_t * tcb = host_thread(thread);
+
+    tcb->sp = (uint32_t) (uintptr_t) tcb->stack_mem + tcb->stack_size - depth;
+}
+
+// Kernel
+
+int32_t osKernelLock(void)
+{
+    host_svc("osKernelLock");
+
+    return host_kernel_lock();
+}
+
+int32_t osKernelUnlock(void)
+{
+    host_svc("osKernelUnlock");
+
+    return host_kernel_unlock();
+}
+
+uint32_t osKernelGetTickCount(void)
+{
+    return (uint32_t) (host_clock_cycles() / (SystemCoreClock / 1000));
+}
+
+// Threads. RTX5 calls the service directly, not through an SVC, when
+// interrupts are masked, so unlike on RTX4 these are fine in a critical
+// section.
+
+osThreadId_t osThreadGetId(void)
+{
+    return osRtxInfo.thread.run.curr;
+}
+
+const char * osThreadGetName(osThreadId_t thread_id)
+{
+    return host_thread(thread_id)->name;
+}
+
+osThreadState_t osThreadGetState(osThreadId_t thread_id)
+{
+    return (osThreadState_t) (host_thread(thread_id)->state & 0x0F);
+}
+
+osPriority_t osThreadGetPriority(osThreadId_t thread_id)
+{
+    return (osPriority_t) host_thread(thread_id)->priority;
+}
+
+uint32_t osThreadGetStackSize(osThreadId_t thread_id)
+{
+    return host_thread(thread_id)->stack_size;
+}
+
+// Refs: rtx_thread.c - svcRtxThreadGetStackSpace()
+uint32_t osThreadGetStackSpace(osThreadId_t thread_id)
+{
+    const osRtxThread_t * tcb   = host_thread(thread_id);
+    const uint32_t      * stack = (const uint32_t *) tcb->stack_mem + 1;
+    uint32_t              space;
+
+    for (space = 4; space < tcb->stack_size; space += 4)
+    {
+        if (*stack++ != osRtxStackFillPattern) break;
+    }
+
+    return space;
+}
+
+// Refs: rtx_thread.c - svcRtxThreadEnumerate(): running, ready, delay, wait.
+uint32_t osThreadEnumerate(osThreadId_t * thread_array, uint32_t array_items)
+{
+    uint32_t        count = 0;
+    osRtxThread_t * tcb;
+
+    if (osRtxInfo.thread.run.curr && count < array_items)
+    {
+        thread_array[count++] = osRtxInfo.thread.run.curr;
+    }
+
+    for (tcb = osRtxInfo.thread.ready.thread_list; tcb && count < array_items; tcb = tcb->thread_next)
+    {
+        thread_array[count++] = tcb;
+    }
+
+    for (tcb = osRtxInfo.thread.delay_list; tcb && count < array_items; tcb = tcb->delay_next)
+    {
+        thread_array[count++] = tcb;
+    }
+
+    for (tcb = osRtxInfo.thread.wait_list; tcb && count < array_items; tcb = tcb->delay_next)
+    {
+        thread_array[count++] = tcb;
+    }
+
+    return count;
+}
+
+uint32_t osThreadGetCount(void)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < HOST_MAX_THREADS; i++)
+    {
+        if (host_tcb(i)->id == osRtxIdThread) count++;
+    }
+
+    return count;
+}
+
+// Mutexes and semaphores
+
+typedef struct
+{
+    uint8_t      id;
+    const char * name;
+    uint32_t     tokens;        // Semaphores only.
+    uint32_t     contend;       // Cycles the next waiting acquire takes.
+    bool         contended;
+    bool         times_out;     // And then fails with osErrorTimeout.
+} host_object_t;
+
+enum
+{
+    HOST_ID_MUTEX     = 0xF5,   // osRtxIdMutex
+    HOST_ID_SEMAPHORE = 0xF6,   // osRtxIdSemaphore
+    HOST_OBJECTS      = 64,
+    HOST_OBJECT_SIZE  = 0x40
+};
+
+static host_object_t * host_object_new(uint8_t id, const char * name)
+{
+    for (uint32_t i = 0; i < HOST_OBJECTS; i++)
+    {
+        host_object_t * object = (host_object_t *) host_ram(HOST_OBJECT_BASE + i * HOST_OBJECT_SIZE);
+
+        if (!object->id)
+        {
+            object->id   = id;
+            object->name = name;
+            return object;
+        }
+    }
+
+    fprintf(stderr, "host: out of mutexes and semaphores\n");
+    abort();
+}
+
+static host_object_t * host_object(void * object, uint8_t id)
+{
+    host_object_t * result = (host_object_t *) object;
+
+    if (!result || result->id != id)
+    {
+        fprintf(stderr, "host: %p is not a %s\n", object, HOST_ID_MUTEX == id ? "mutex" : "semaphore");
+        abort();
+    }
+
+    return result;
+}
+
+void host_object_contend(void * object, uint32_t cycles)
+{
+    host_object_t * result = (host_object_t *) object;
+
+    result->contend   = cycles;
+    result->contended = true;
+    result->times_out = false;
+}
+
+void host_object_time_out(void * object, uint32_t cycles)
+{
+    host_object_contend(object, cycles);
+
+    ((host_object_t *) object)->times_out = true;
+}
+
+// The control block is zeroed, so the next object created reuses it.
+static osStatus_t host_object_delete(host_object_t * object)
+{
+    host_svc(HOST_ID_MUTEX == object->id ? "osMutexDelete" : "osSemaphoreDelete");
+
+    memset(object, 0, sizeof(*object));
+
+    return osOK;
+}
+
+// Mutexes are always free unless contended; ownership is not modelled.
+static osStatus_t host_object_acquire(host_object_t * object, uint32_t timeout)
+{
+    host_svc(HOST_ID_MUTEX == object->id ? "osMutexAcquire" : "osSemaphoreAcquire");
+
+    if (object->contended)
+    {
+        if (!timeout) return osErrorResource;
+
+        host_clock_advance(object->contend);
+        object->contended = false;
+
+        if (object->times_out) return osErrorTimeout;
+    }
+    else if (HOST_ID_SEMAPHORE == object->id)
+    {
+        if (!object->tokens) return timeout ? osErrorTimeout : osErrorResource;
+
+        object->tokens--;
+    }
+
+    return osOK;
+}
+
+osMutexId_t osMutexNew(const osMutexAttr_t * attr)
+{
+    return host_object_new(HOST_ID_MUTEX, attr ? attr->name : NULL);
+}
+
+const char * osMutexGetName(osMutexId_t mutex_id)
+{
+    return host_object(mutex_id, HOST_ID_MUTEX)->name;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    return host_object_acquire(host_object(mutex_id, HOST_ID_MUTEX), timeout);
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id)
+{
+    host_object(mutex_id, HOST_ID_MUTEX);
+
+    return osOK;
+}
+
+osStatus_t osMutexDelete(osMutexId_t mutex_id)
+{
+    return host_object_delete(host_object(mutex_id, HOST_ID_MUTEX));
+}
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t * attr)
+{
+    (void) max_count;
+
+    host_object_t * object = host_object_new(HOST_ID_SEMAPHORE, attr ? attr->name : NULL);
+
+    object->tokens = initial_count;
+
+    return object;
+}
+
+const char * osSemaphoreGetName(osSemaphoreId_t semaphore_id)
+{
+    return host_object(semaphore_id, HOST_ID_SEMAPHORE)->name;
+}
+
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+    return host_object_acquire(host_object(semaphore_id, HOST_ID_SEMAPHORE), timeout);
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id)
+{
+    host_object(semaphore_id, HOST_ID_SEMAPHORE)->tokens++;
+
+    return osOK;
+}
+
+osStatus_t osSemaphoreDelete(osSemaphoreId_t semaphore_id)
+{
+    return host_object_delete(host_object(semaphore_id, HOST_ID_SEMAPHORE));
+}
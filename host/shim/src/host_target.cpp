@@ -0,0 +1,425 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Target RAM, clock, output capture and the mbed platform / HAL
+ *          functions, common to every RTOS backend.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "mbed.h"
+#include "hal/serial_api.h"
+#include "hal/us_ticker_api.h"
+#include "platform/mbed_critical.h"
+#include "platform/mbed_mem_trace.h"
+#include "platform/mbed_stats.h"
+
+#include "host_internal.h"
+
+// Target RAM
+
+static void host_ram_map(void)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED;
+
+#ifdef MAP_FIXED_NOREPLACE
+    flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE;
+#endif
+
+    void * ram = mmap(HOST_POINTER(HOST_RAM_BASE), HOST_RAM_SIZE, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+    if (ram != HOST_POINTER(HOST_RAM_BASE))
+    {
+        fprintf(stderr, "host: cannot map target RAM at %08X\n", (unsigned) HOST_RAM_BASE);
+        abort();
+    }
+}
+
+void * host_ram(uint32_t address)
+{
+    if (address < HOST_RAM_BASE || address - HOST_RAM_BASE >= HOST_RAM_SIZE)
+    {
+        fprintf(stderr, "host: %08X is not in target RAM\n", (unsigned) address);
+        abort();
+    }
+
+    return HOST_POINTER(address);
+}
+
+static uint32_t host_stack_next = HOST_STACK_BASE;
+
+uint32_t host_stack_alloc(uint32_t size)
+{
+    uint32_t stack = host_stack_next;
+
+    size = (size + 7) & ~7U;
+
+    if (size > HOST_STACK_LIMIT - stack)
+    {
+        fprintf(stderr, "host: out of target RAM for stacks\n");
+        abort();
+    }
+
+    host_stack_next += size;
+
+    return stack;
+}
+
+// mbed's linker-provided symbols. __StackLimit / __StackTop come from
+// --defsym in CMakeLists.txt, at the same place.
+
+unsigned char * mbed_heap_start      = (unsigned char *) HOST_POINTER(HOST_HEAP_START);
+uint32_t        mbed_heap_size       = HOST_HEAP_SIZE;
+unsigned char * mbed_stack_isr_start = (unsigned char *) HOST_POINTER(HOST_ISR_STACK_TOP - HOST_ISR_STACK_SIZE);
+uint32_t        mbed_stack_isr_size  = HOST_ISR_STACK_SIZE;
+
+// Output
+
+static char   * host_output_buffer   = NULL;
+static uint32_t host_output_used     = 0;
+static uint32_t host_output_capacity = 0;
+static bool     host_output_dropping = false;
+
+uint32_t host_serial_cycles_per_byte = 0;
+
+void host_output_clear(void)
+{
+    host_output_used = 0;
+
+    if (host_output_buffer) host_output_buffer[0] = '\0';
+}
+
+const char * host_output(void)
+{
+    return host_output_buffer ? host_output_buffer : "";
+}
+
+uint32_t host_output_length(void)
+{
+    return host_output_used;
+}
+
+void host_output_discard(bool discard)
+{
+    host_output_dropping = discard;
+}
+
+int      stdio_uart_inited = 0;
+serial_t stdio_uart;
+
+void serial_init(serial_t * obj, int tx, int rx)
+{
+    (void) tx;
+    (void) rx;
+
+    obj->baudrate = 9600;
+    stdio_uart_inited = 1;
+}
+
+void serial_baud(serial_t * obj, int baudrate)
+{
+    obj->baudrate = (uint32_t) baudrate;
+}
+
+void serial_putc(serial_t * obj, int c)
+{
+    (void) obj;
+
+    host_clock_advance(host_serial_cycles_per_byte);
+
+    if (host_output_dropping)
+    {
+        host_output_used++;
+        return;
+    }
+
+    if (host_output_used + 2 > host_output_capacity)
+    {
+        host_output_capacity = host_output_capacity ? host_output_capacity * 2 : 4096;
+        host_output_buffer   = (char *) realloc(host_output_buffer, host_output_capacity);
+
+        if (!host_output_buffer) abort();
+    }
+
+    host_output_buffer[host_output_used++] = (char) c;
+    host_output_buffer[host_output_used]   = '\0';
+}
+
+// Clock
+
+uint32_t        SystemCoreClock   = 64000000;
+static uint64_t host_clock        = 0;
+
+void host_clock_advance(uint32_t cycles)
+{
+    host_clock += cycles;
+}
+
+uint64_t host_clock_cycles(void)
+{
+    return host_clock;
+}
+
+uint32_t us_ticker_read(void)
+{
+    return (uint32_t) (host_clock / (SystemCoreClock / 1000000));
+}
+
+host_dwt_t        host_dwt;
+host_core_debug_t host_core_debug;
+
+host_cyccnt_t::operator uint32_t() const volatile
+{
+    if (!(host_dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) || !(host_core_debug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk)) return 0;
+
+    return (uint32_t) host_clock;
+}
+
+// Heap statistics
+
+mbed_stats_heap_t host_heap_stats;
+
+void mbed_stats_heap_get(mbed_stats_heap_t * stats)
+{
+    host_svc("mbed_stats_heap_get"); // Takes the malloc mutex.
+
+    *stats = host_heap_stats;
+}
+
+// Critical sections
+
+static int host_critical = 0;
+
+void core_util_critical_section_enter(void)
+{
+    host_critical++;
+}
+
+void core_util_critical_section_exit(void)
+{
+    if (host_critical <= 0)
+    {
+        fprintf(stderr, "host: critical section exit without enter\n");
+        abort();
+    }
+
+    host_critical--;
+}
+
+bool core_util_in_critical_section(void)
+{
+    return host_critical > 0;
+}
+
+int host_critical_depth(void)
+{
+    return host_critical;
+}
+
+uint32_t core_util_atomic_incr_u32(volatile uint32_t * valuePtr, uint32_t delta)
+{
+    return __sync_add_and_fetch(valuePtr, delta);
+}
+
+uint32_t core_util_atomic_decr_u32(volatile uint32_t * valuePtr, uint32_t delta)
+{
+    return __sync_sub_and_fetch(valuePtr, delta);
+}
+
+void host_svc(const char * function)
+{
+    if (host_critical > 0)
+    {
+        fprintf(stderr, "host: HardFault, SVC with interrupts masked in %s()\n", function);
+        abort();
+    }
+}
+
+// Kernel lock
+
+static int32_t  host_kernel_locked = 0;
+static uint32_t host_kernel_locks  = 0;
+
+int32_t host_kernel_lock(void)
+{
+    int32_t previous = host_kernel_locked ? 1 : 0;
+
+    host_kernel_locked++;
+    host_kernel_locks++;
+
+    return previous;
+}
+
+int32_t host_kernel_unlock(void)
+{
+    if (host_kernel_locked <= 0)
+    {
+        fprintf(stderr, "host: kernel unlock without lock\n");
+        abort();
+    }
+
+    return host_kernel_locked-- ? 1 : 0;
+}
+
+int host_kernel_lock_depth(void)
+{
+    return host_kernel_locked;
+}
+
+uint32_t host_kernel_lock_count(void)
+{
+    return host_kernel_locks;
+}
+
+// Exception frame: R0, R1, R2, R3, R12, LR, PC, xPSR.
+
+uint32_t __get_PSP(void)
+{
+    return HOST_EXCEPTION_FRAME;
+}
+
+void host_set_exception_pc(uint32_t pc)
+{
+    uint32_t * frame = (uint32_t *) host_ram(HOST_EXCEPTION_FRAME);
+
+    memset(frame, 0, 8 * sizeof(uint32_t));
+
+    frame[6] = pc;
+    frame[7] = 0x01000000; // Thumb bit.
+}
+
+static uint32_t host_ipsr = 0;
+
+uint32_t __get_IPSR(void)
+{
+    return host_ipsr;
+}
+
+void host_set_ipsr(uint32_t ipsr)
+{
+    host_ipsr = ipsr;
+}
+
+// Ticker
+
+static Ticker * host_tickers = NULL;
+
+Ticker::Ticker() : func(NULL), interval_us(0), next(host_tickers)
+{
+    host_tickers = this;
+}
+
+Ticker::~Ticker()
+{
+    for (Ticker ** link = &host_tickers; *link; link = &(*link)->next)
+    {
+        if (*link == this)
+        {
+            *link = next;
+            break;
+        }
+    }
+}
+
+void Ticker::attach_us(void (*callback)(void), uint32_t us)
+{
+    func        = callback;
+    interval_us = us;
+}
+
+void Ticker::detach(void)
+{
+    func = NULL;
+}
+
+void host_ticker_fire(void)
+{
+    for (Ticker * ticker = host_tickers; ticker; ticker = ticker->next)
+    {
+        if (ticker->func) ticker->func();
+    }
+}
+
+// Memory tracing
+
+static mbed_mem_trace_cb_t host_trace_callback = NULL;
+
+void mbed_mem_trace_set_callback(mbed_mem_trace_cb_t cb)
+{
+    host_trace_callback = cb;
+}
+
+void host_trace_malloc(void * result, uint32_t size, void * caller)
+{
+    if (host_trace_callback) host_trace_callback(MBED_MEM_TRACE_MALLOC, result, caller, (size_t) size);
+}
+
+void host_trace_realloc(void * result, void * ptr, uint32_t size, void * caller)
+{
+    if (host_trace_callback) host_trace_callback(MBED_MEM_TRACE_REALLOC, result, caller, ptr, (size_t) size);
+}
+
+void host_trace_calloc(void * result, uint32_t count, uint32_t size, void * caller)
+{
+    if (host_trace_callback) host_trace_callback(MBED_MEM_TRACE_CALLOC, result, caller, (size_t) count, (size_t) size);
+}
+
+void host_trace_free(void * ptr, void * caller)
+{
+    if (host_trace_callback) host_trace_callback(MBED_MEM_TRACE_FREE, NULL, caller, ptr);
+}
+
+// Reset
+
+void host_reset(void)
+{
+    memset(HOST_POINTER(HOST_RAM_BASE), 0, HOST_RAM_SIZE);
+
+    host_stack_next = HOST_STACK_BASE;
+
+    host_output_clear();
+    host_output_dropping        = false;
+    host_serial_cycles_per_byte = 0;
+
+    host_clock         = 0;
+    host_critical      = 0;
+    host_kernel_locked = 0;
+    host_kernel_locks  = 0;
+    host_ipsr          = 0;
+
+    memset(&host_heap_stats, 0, sizeof(host_heap_stats));
+
+    host_rtos_reset();
+}
+
+// Before any test code, and before static constructors that might touch
+// target RAM.
+__attribute__((constructor(101))) static void host_start(void)
+{
+    host_ram_map();
+    host_reset();
+}
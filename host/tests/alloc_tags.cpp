@@ -0,0 +1,274 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Allocation tags on the wrapped allocator. On CMSIS-RTOS 1,
+ *          where osThreadGetId() is an SVC, this also checks that it is
+ *          never called with interrupts masked (the shim aborts if it is).
+ *          Scopes on more threads than fit, and on a thread deleted
+ *          inside one. With quotas, built with MEMORY_STATUS_MAX_TAGS=4 and
+ *          ALLOC_TAG_SLOTS=8: what happens once the tag table, or the
+ *          block table, is full.
+ */
+
+// For alloc_tag_stats[] and alloc_tag_threads[], which are static.
+#include "../../mbed_memory_status.cpp"
+
+#include <stdlib.h>
+
+#include "host_test.h"
+
+static uint32_t live(const char * name)
+{
+    for (uint32_t tag = 0; tag < alloc_tag_count; tag++)
+    {
+        if (0 == strcmp(alloc_tag_names[tag], name)) return alloc_tag_stats[tag].live;
+    }
+
+    return 0xFFFFFFFF;
+}
+
+int main(void)
+{
+    host_thread_config_t config = host_thread_config_t();
+
+    config.name       = "main";
+    config.entry      = 0x00012345;
+    config.stack_size = 0x0400;
+    config.stack_used = 0x0060;
+
+    void * main_thread = host_thread_create(&config);
+
+    host_thread_switch(main_thread);
+
+    // volatile, or the compiler may drop a malloc() / free() pair.
+    void * volatile outer = NULL;
+    void * volatile inner = NULL;
+
+    {
+        MemTagScope scope("net");
+
+        outer = malloc(100);
+
+        {
+            MemTagScope scope("tls");
+
+            inner = calloc(4, 16);
+        }
+
+        outer = realloc(outer, 200);
+    }
+
+    void * volatile untagged = malloc(24);
+
+    HOST_TEST_CHECK(outer && inner && untagged);
+    HOST_TEST_CHECK(200 == live("net"));
+    HOST_TEST_CHECK(64  == live("tls"));
+    HOST_TEST_CHECK(24  == live("untagged"));
+
+    free(outer);
+    free(inner);
+    free(untagged);
+
+    HOST_TEST_CHECK(0 == live("net"));
+    HOST_TEST_CHECK(0 == live("tls"));
+    HOST_TEST_CHECK(0 == live("untagged"));
+
+    // No name, no change.
+    {
+        MemTagScope scope("net");
+
+        {
+            MemTagScope scope(NULL);
+
+            outer = malloc(8);
+        }
+
+        inner = malloc(8);
+    }
+
+    HOST_TEST_CHECK(16 == live("net"));
+
+    free(outer);
+    free(inner);
+
+    // Scopes on more threads than fit: the last one is refused, counted,
+    // and keeps its tag.
+    void *   threads[ALLOC_TAG_THREADS + 1];
+    uint32_t previous[ALLOC_TAG_THREADS + 1];
+
+    config.name = "worker";
+
+    for (uint32_t i = 0; i <= ALLOC_TAG_THREADS; i++)
+    {
+        threads[i] = host_thread_create(&config);
+        host_thread_switch(threads[i]);
+
+        previous[i] = memory_status_tag_enter("tls");
+    }
+
+    HOST_TEST_CHECK(0 == previous[0]);
+    HOST_TEST_CHECK(MEMORY_STATUS_TAG_ERROR == previous[ALLOC_TAG_THREADS]);
+    HOST_TEST_CHECK(1 == alloc_tag_overflows);
+
+    outer = malloc(8);
+
+    HOST_TEST_CHECK(8 == live("untagged"));
+    HOST_TEST_CHECK(0 == live("tls"));
+
+    free(outer);
+    memory_status_tag_leave(previous[ALLOC_TAG_THREADS]);
+
+    // A thread deleted inside its scope: the next one created gets the same
+    // control block, but not its tag.
+    host_thread_switch(threads[1]);
+    host_thread_exit(threads[0]);
+
+#if !MEMORY_STATUS_THREAD_EVENTS
+    memory_status_thread_destroyed(threads[0]);
+#endif
+
+    void * reused = host_thread_create(&config);
+
+    HOST_TEST_CHECK(reused == threads[0]);
+
+    host_thread_switch(reused);
+
+    HOST_TEST_CHECK(0 == alloc_tag_current());
+
+    // Which also made room for it.
+    previous[0] = memory_status_tag_enter("tls");
+
+    HOST_TEST_CHECK(0 == previous[0]);
+    HOST_TEST_CHECK(1 == alloc_tag_overflows);
+
+    for (uint32_t i = 0; i <= ALLOC_TAG_THREADS; i++)
+    {
+        host_thread_switch(threads[i]);
+
+        outer = malloc(8);
+
+        if (i < ALLOC_TAG_THREADS) HOST_TEST_CHECK(8 == live("tls"));
+
+        free(outer);
+        memory_status_tag_leave(previous[i]);
+
+        HOST_TEST_CHECK(0 == alloc_tag_current());
+    }
+
+    for (uint32_t i = 0; i < ALLOC_TAG_THREADS; i++) HOST_TEST_CHECK(!alloc_tag_threads[i].thread);
+
+    for (uint32_t i = 0; i <= ALLOC_TAG_THREADS; i++) host_thread_exit(threads[i]);
+
+    host_thread_switch(main_thread);
+
+#if DEBUG_ALLOC_QUOTAS
+    HOST_TEST_CHECK(MEMORY_STATUS_MAX_TAGS == 4);
+
+    // "untagged", "net", "tls", and one more fill the table.
+    HOST_TEST_CHECK(memory_status_tag_quota("dns", 64));
+    HOST_TEST_CHECK(0 == alloc_tag_refused);
+
+    // A quota for a name that did not fit is refused, not put on "untagged".
+    HOST_TEST_CHECK(!memory_status_tag_quota("mqtt", 64));
+    HOST_TEST_CHECK(1 == alloc_tag_refused);
+    HOST_TEST_CHECK(0xFFFFFFFF == alloc_tag_quota[0]);
+
+    // A scope with a name that did not fit charges "untagged".
+    {
+        MemTagScope scope("mqtt");
+
+        outer = malloc(32);
+    }
+
+    HOST_TEST_CHECK(2  == alloc_tag_refused);
+    HOST_TEST_CHECK(32 == live("untagged"));
+
+    free(outer);
+
+    // Existing names and "untagged" still take quotas.
+    HOST_TEST_CHECK(memory_status_tag_quota("net", 128));
+
+    // count * size wraps around to 256: fails before the quota is looked at.
+    {
+        MemTagScope scope("net");
+
+        volatile size_t count = (size_t) -1 / 256 + 2;
+
+        outer = calloc(count, 256);
+
+        HOST_TEST_CHECK(!outer);
+        HOST_TEST_CHECK(0 == alloc_tag_stats[1].denied);
+    }
+    HOST_TEST_CHECK(memory_status_tag_quota(NULL, 4096));
+    HOST_TEST_CHECK(2 == alloc_tag_refused);
+
+    HOST_TEST_CHECK(memory_status_tag_quota(NULL, 0));
+
+    // Fill the block table.
+    static void * volatile blocks[ALLOC_TAG_SLOTS];
+
+    for (uint32_t i = 0; i < ALLOC_TAG_SLOTS; i++) blocks[i] = malloc(8);
+
+    HOST_TEST_CHECK(8 * ALLOC_TAG_SLOTS == live("untagged"));
+
+    // Without a quota, the block is allocated but not tracked.
+    outer = malloc(8);
+
+    HOST_TEST_CHECK(outer);
+    HOST_TEST_CHECK(8 * ALLOC_TAG_SLOTS == live("untagged"));
+    HOST_TEST_CHECK(1 == alloc_tag_blocks.untracked);
+
+    // With one, it is denied: untracked, it would not count against it.
+    {
+        MemTagScope scope("net");
+
+        inner = malloc(8);
+
+        HOST_TEST_CHECK(!inner);
+        HOST_TEST_CHECK(0 == live("net"));
+        HOST_TEST_CHECK(1 == alloc_tag_stats[1].denied);
+        HOST_TEST_CHECK(2 == alloc_tag_blocks.untracked);
+
+        free(blocks[0]);
+
+        inner = malloc(8);
+
+        HOST_TEST_CHECK(inner);
+        HOST_TEST_CHECK(8 == live("net"));
+    }
+
+    free(outer);
+    free(inner);
+
+    for (uint32_t i = 1; i < ALLOC_TAG_SLOTS; i++) free(blocks[i]);
+
+    HOST_TEST_CHECK(0 == live("net"));
+    HOST_TEST_CHECK(0 == live("untagged"));
+    HOST_TEST_CHECK(ALLOC_TAG_SLOTS == alloc_tag_entries_free);
+#endif
+
+    HOST_TEST_CHECK(0 == host_critical_depth());
+
+    return 0;
+}
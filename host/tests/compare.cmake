@@ -0,0 +1,31 @@
+# Runs PROGRAM and compares what it prints with the file GOLDEN, or writes
+# it there when UPDATE is on.
+
+execute_process(
+    COMMAND "${PROGRAM}"
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE  errors
+    RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${PROGRAM} failed (${result}):\n${errors}")
+endif()
+
+if(UPDATE)
+    file(WRITE "${GOLDEN}" "${output}")
+    message(STATUS "Updated ${GOLDEN}")
+    return()
+endif()
+
+if(NOT EXISTS "${GOLDEN}")
+    message(FATAL_ERROR "${GOLDEN} missing, run with -DUPDATE_GOLDEN=ON to create it.")
+endif()
+
+file(READ "${GOLDEN}" expected)
+
+if(NOT output STREQUAL expected)
+    get_filename_component(name "${GOLDEN}" NAME)
+    file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/${name}.actual" "${output}")
+
+    message(FATAL_ERROR "Output differs from ${GOLDEN}, see ${CMAKE_CURRENT_BINARY_DIR}/${name}.actual:\n${output}")
+endif()
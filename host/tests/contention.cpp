@@ -0,0 +1,99 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Waits that time out are recorded, and a mutex created where a
+ *          deleted one was starts with a fresh slot.
+ */
+
+// For contention_slots, which is static.
+#include "../../mbed_memory_status.cpp"
+
+#include "host_test.h"
+
+static const contention_slot_t * slot_of(const void * object)
+{
+    return contention_slot(object, 0, false);
+}
+
+int main(void)
+{
+    osMutexAttr_t attr = osMutexAttr_t();
+
+    attr.name = "first";
+
+    osMutexId_t mutex = osMutexNew(&attr);
+
+    // Free, then held for 100 cycles by someone else.
+    HOST_TEST_CHECK(osOK == osMutexAcquire(mutex, osWaitForever));
+    host_object_contend(mutex, 100);
+    HOST_TEST_CHECK(osOK == osMutexAcquire(mutex, osWaitForever));
+
+    // Held for 300 cycles, longer than the caller is willing to wait.
+    host_object_time_out(mutex, 300);
+    HOST_TEST_CHECK(osErrorTimeout == osMutexAcquire(mutex, 300));
+
+    const contention_slot_t * slot = slot_of(mutex);
+
+    HOST_TEST_CHECK(slot != &contention_untracked);
+    HOST_TEST_CHECK(slot->acquired   == 2);
+    HOST_TEST_CHECK(slot->contended  == 2);
+    HOST_TEST_CHECK(slot->timeouts   == 1);
+    HOST_TEST_CHECK(slot->wait_max   >= 300);
+    HOST_TEST_CHECK(slot->wait_total >= 400);
+
+    // A semaphore without tokens times out at once, which still counts.
+    osSemaphoreId_t semaphore = osSemaphoreNew(1, 0, NULL);
+
+    HOST_TEST_CHECK(osErrorTimeout == osSemaphoreAcquire(semaphore, 10));
+    HOST_TEST_CHECK(slot_of(semaphore)->timeouts == 1);
+    HOST_TEST_CHECK(slot_of(semaphore)->acquired == 0);
+
+    // The report shows timeouts.
+    host_output_clear();
+    print_contention_info();
+    HOST_TEST_CHECK(strstr(host_output(), "name: first ) contention ( acquired: 00000002 contended: 00000002 timeouts: 00000001 "));
+
+    // Deleted and re-created in the same control block: a new slot.
+    HOST_TEST_CHECK(osOK == osMutexDelete(mutex));
+    HOST_TEST_CHECK(slot_of(mutex) == &contention_untracked);
+
+    attr.name = "second";
+
+    HOST_TEST_CHECK(osMutexNew(&attr) == mutex);
+    HOST_TEST_CHECK(osOK == osMutexAcquire(mutex, osWaitForever));
+
+    slot = slot_of(mutex);
+
+    HOST_TEST_CHECK(slot->acquired  == 1);
+    HOST_TEST_CHECK(slot->contended == 0);
+    HOST_TEST_CHECK(slot->timeouts  == 0);
+
+    // The semaphore's slot survived the delete, whatever was shifted.
+    HOST_TEST_CHECK(slot_of(semaphore)->timeouts == 1);
+
+    HOST_TEST_CHECK(osOK == osSemaphoreDelete(semaphore));
+    HOST_TEST_CHECK(slot_of(semaphore) == &contention_untracked);
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: DEBUG_SELF_COST on the host DWT stand-in. Only the serial port
+ *          moves the virtual clock here, so every cycle a report costs is
+ *          a serial cycle, and the trailer line is exact.
+ */
+
+#include "mbed.h"
+#include "mbed_memory_status.h"
+
+#include "host_test.h"
+
+static const uint32_t CYCLES_PER_BYTE = 4;
+
+static void check_cost(void)
+{
+    memory_status_cost_t cost;
+
+    get_memory_status_cost(&cost);
+
+    HOST_TEST_CHECK(cost.ticks_per_second == SystemCoreClock);
+    HOST_TEST_CHECK(cost.serial_bytes > 0);
+    HOST_TEST_CHECK(cost.serial_ticks == cost.serial_bytes * CYCLES_PER_BYTE);
+    HOST_TEST_CHECK(cost.total_ticks == cost.serial_ticks);
+    HOST_TEST_CHECK(0 == cost.kernel_locked_ticks);
+}
+
+int main(void)
+{
+    host_thread_config_t config = host_thread_config_t();
+
+    config.name       = "main";
+    config.entry      = 0x00012345;
+    config.stack_size = 0x0800;
+    config.stack_used = 0x0100;
+
+    host_thread_switch(host_thread_create(&config));
+
+    config.name       = "worker";
+    config.entry      = 0x000123A1;
+    config.stack_size = 0x0400;
+    config.stack_used = 0x0080;
+
+    host_thread_create(&config);
+
+    host_serial_cycles_per_byte = CYCLES_PER_BYTE;
+
+    print_all_thread_info();
+    host_test_print("threads");
+    check_cost();
+
+    print_heap_and_isr_stack_info();
+    host_test_print("heap and isr stack");
+    check_cost();
+
+    return 0;
+}
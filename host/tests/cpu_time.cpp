@@ -0,0 +1,141 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: DEBUG_THREAD_CPU_TIME's thread table: slots of exited threads
+ *          are released at report time, and a thread that reuses an exited
+ *          thread's control block starts from zero.
+ */
+
+// For thread_slots[] and thread_slot(), which are static.
+#include "../../mbed_memory_status.cpp"
+
+#include "host_test.h"
+
+static uint32_t slots_used(void)
+{
+    uint32_t used = 0;
+
+    for (uint32_t i = 0; i < THREAD_SLOTS; i++)
+    {
+        if (!thread_slots[i].thread) continue;
+
+        // Still found where lookups probe for it.
+        HOST_TEST_CHECK(&thread_slots[i] == thread_slot(thread_slots[i].thread, false));
+
+        used++;
+    }
+
+    return used;
+}
+
+static void * fake_thread(uint32_t i)
+{
+    return (void *) (uintptr_t) (0x30000000 + (i / 2) * 8 + (i % 2) * 8 * THREAD_SLOTS);
+}
+
+int main(void)
+{
+    host_thread_config_t config = host_thread_config_t();
+
+    config.name       = "main";
+    config.entry      = 0x00012345;
+    config.stack_size = 0x0400;
+    config.stack_used = 0x0060;
+
+    void * main_thread = host_thread_create(&config);
+
+    host_thread_switch(main_thread);
+
+    // Threads that come and go between reports, more than there are slots.
+    // Every other one has the same home slot as the one before it.
+    for (uint32_t i = 0; i < 2 * THREAD_SLOTS; i++)
+    {
+        memory_status_thread_switched(fake_thread(i));
+        host_clock_advance(100);
+    }
+
+    host_thread_switch(main_thread);
+    host_clock_advance(100 * 2 * THREAD_SLOTS);
+
+    HOST_TEST_CHECK(THREAD_SLOTS == slots_used());
+
+    print_all_thread_info();
+    host_test_print("table full");
+
+    // They ran since the previous report, so they are kept for this one.
+    HOST_TEST_CHECK(THREAD_SLOTS == slots_used());
+
+    // Half of them run again.
+    uint32_t running = 1;
+
+    for (uint32_t i = 0; i < 2 * THREAD_SLOTS; i += 2)
+    {
+        running += (&thread_untracked != thread_slot(fake_thread(i), false));
+
+        memory_status_thread_switched(fake_thread(i));
+    }
+
+    host_thread_switch(main_thread);
+
+    print_all_thread_info();
+    host_test_print("half of them again");
+
+    HOST_TEST_CHECK(running == slots_used());
+
+    print_all_thread_info();
+    host_test_print("none of them");
+
+    // Only main was in the report, and nothing else ran since.
+    HOST_TEST_CHECK(1 == slots_used());
+
+    config.name       = "first";
+    config.entry      = 0x000123A1;
+    config.stack_size = 0x0200;
+    config.stack_used = 0x0020;
+
+    void * first = host_thread_create(&config);
+
+    host_thread_switch(first);
+    host_clock_advance(3000);
+    host_thread_switch(main_thread);
+    host_thread_exit(first);
+
+    config.name = "second";
+
+    void * second = host_thread_create(&config);
+
+    HOST_TEST_CHECK(second == first);
+
+    host_thread_switch(second);
+    host_clock_advance(1000);
+    host_thread_switch(main_thread);
+    host_clock_advance(1000);
+
+    print_all_thread_info();
+    host_test_print("reused control block");
+
+    HOST_TEST_CHECK(2 == slots_used());
+
+    return 0;
+}
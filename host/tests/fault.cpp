@@ -0,0 +1,88 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: print_fault_memory_status() walking the RTX5 thread lists
+ *          directly, for a fault on a thread stack and on the ISR stack,
+ *          and with a corrupt TCB.
+ */
+
+#include "mbed.h"
+#include "mbed_memory_status.h"
+#include "rtx_lib.h"
+
+#include "host_test.h"
+
+int main(void)
+{
+    host_thread_config_t config = host_thread_config_t();
+
+    config.name       = "main";
+    config.entry      = 0x00012345;
+    config.stack_size = 0x0400;
+    config.stack_used = 0x0060;
+
+    void * main_thread = host_thread_create(&config);
+
+    config.name       = "worker";
+    config.entry      = 0x000123A1;
+    config.stack_size = 0x0200;
+    config.stack_used = 0x0020;
+
+    void * worker = host_thread_create(&config);
+
+    host_thread_switch(main_thread);
+    host_thread_block(worker, true);
+    host_thread_set_depth(worker, 0x18);
+
+    // Fault on the running thread's stack, 0x40 bytes deep.
+    print_fault_memory_status(0x20002100 + 0x0400 - 0x40);
+    host_test_print("thread stack");
+
+    // Fault in an interrupt handler.
+    uint32_t * isr = (uint32_t *) host_ram(HOST_ISR_STACK_TOP - 0x20);
+
+    for (uint32_t i = 0; i < 8; i++) isr[i] = 0xA0000000 + i;
+
+    print_fault_memory_status(HOST_ISR_STACK_TOP - 0x20);
+    host_test_print("isr stack");
+
+    // A corrupt TCB: its stack is not scanned, nor taken to hold sp.
+    os_thread_t * tcb = (os_thread_t *) worker;
+
+    tcb->stack_size = 0x7FFFFFF0;
+
+    print_fault_memory_status(0x20002500 + 0x0200 - 0x10);
+    host_test_print("stack size out of range");
+
+    tcb->stack_size = 0x0200;
+    tcb->stack_mem  = (void *) (uintptr_t) 0x10000000;
+
+    print_fault_memory_status(0x20002500 + 0x0200 - 0x10);
+    host_test_print("stack outside RAM");
+
+    HOST_TEST_CHECK(0 == host_critical_depth());
+    HOST_TEST_CHECK(0 == host_kernel_lock_count());
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: OUTPUT_FRAMING records: a line longer than one record, a writer
+ *          that finds the record already full, and a fault interrupting a
+ *          half-written line. Records are decoded and printed one per line.
+ */
+
+// For frame_append() and frame_length, which are static.
+#include "../../mbed_memory_status.cpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "host_test.h"
+
+// Prints every record in the captured output as "seq: payload", with the
+// payload's \r and \n escaped, and checks its CRC.
+static void print_records(const char * title)
+{
+    const uint8_t * input  = (const uint8_t *) host_output();
+    uint32_t        length = host_output_length();
+    uint8_t         record[FRAME_RECORD_SIZE];
+
+    printf("-- %s --\n", title);
+
+    for (uint32_t start = 0; start < length; )
+    {
+        uint32_t end = start;
+
+        while (end < length && input[end] != 0) end++;
+
+        HOST_TEST_CHECK(end < length);
+
+        uint32_t size = 0;
+
+        for (uint32_t i = start; i < end; )
+        {
+            uint8_t code = input[i++];
+
+            for (uint8_t n = 1; n < code; n++)
+            {
+                HOST_TEST_CHECK(size < sizeof(record) && i < end);
+                record[size++] = input[i++];
+            }
+
+            if (code != 0xFF && i < end)
+            {
+                HOST_TEST_CHECK(size < sizeof(record));
+                record[size++] = 0;
+            }
+        }
+
+        HOST_TEST_CHECK(size >= 4);
+
+        uint16_t crc = (uint16_t) (record[size - 2] | (record[size - 1] << 8));
+
+        HOST_TEST_CHECK(crc == crc16_ccitt(record, size - 2));
+
+        printf("%u: ", (unsigned) (record[0] | (record[1] << 8)));
+
+        for (uint32_t i = 2; i < size - 2; i++)
+        {
+            if      (record[i] == '\r') printf("\\r");
+            else if (record[i] == '\n') printf("\\n");
+            else                        putchar(record[i]);
+        }
+
+        putchar('\n');
+
+        start = end + 1;
+    }
+
+    host_output_clear();
+}
+
+int main(void)
+{
+    char line[2 * FRAME_PAYLOAD_SIZE + 16];
+
+    for (uint32_t i = 0; i < sizeof(line) - 3; i++) line[i] = (char) ('a' + i % 26);
+
+    strcpy(line + sizeof(line) - 3, "\r\n");
+
+    nway_print_label(line);
+    print_records("long line");
+
+    // As a writer preempted between checking the length and storing would
+    // leave it: already at the end of the payload. The next byte has to
+    // start a new record, not go past this one.
+    memset(frame_record + 2, '.', FRAME_PAYLOAD_SIZE);
+    frame_length = 2 + FRAME_PAYLOAD_SIZE;
+
+    nway_print_label("next\r\n");
+    HOST_TEST_CHECK(frame_length == 2);
+    print_records("full record");
+
+    // A fault in the middle of a line drops the half-written record.
+    nway_print_label("half a li");
+    print_fault_memory_status(HOST_ISR_STACK_TOP - 0x20);
+    print_records("fault");
+
+    HOST_TEST_CHECK(0 == host_critical_depth());
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Shared by the host test programs. Each prints a title, runs part
+ *          of the library, then prints what the library wrote.
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_target.h"
+
+// Prints the captured output under title, and clears it.
+static inline void host_test_print(const char * title)
+{
+    printf("-- %s --\n", title);
+    fwrite(host_output(), 1, host_output_length(), stdout);
+    host_output_clear();
+}
+
+// For results that are not library output.
+#define HOST_TEST_CHECK(CONDITION)                                              \
+    do                                                                          \
+    {                                                                           \
+        if (!(CONDITION))                                                       \
+        {                                                                       \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #CONDITION);     \
+            exit(1);                                                            \
+        }                                                                       \
+    } while (0)
+
+#endif /* HOST_TEST_H */
@@ -0,0 +1,94 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Allocation lifetimes measured across the wrap of us_ticker_read()
+ *          (CMSIS-RTOS 1 and no RTOS).
+ */
+
+// For alloc_size_classes, which is static.
+#include "../../mbed_memory_status.cpp"
+
+#include "host_test.h"
+
+static void advance_us(uint64_t us)
+{
+    uint64_t cycles = us * (SystemCoreClock / 1000000);
+
+    while (cycles)
+    {
+        uint32_t step = cycles > 0x40000000 ? 0x40000000 : (uint32_t) cycles;
+
+        host_clock_advance(step);
+        cycles -= step;
+    }
+}
+
+// Lifetimes of freed 64 byte blocks, by log2 ms bucket.
+static const uint16_t * lifetimes(void)
+{
+    return alloc_size_classes[alloc_size_class(64)].lifetime;
+}
+
+int main(void)
+{
+    void * block = (void *) 0x20001000;
+
+    memory_status_heap_trace_begin();
+
+    // Lives 10 ms.
+    host_trace_malloc(block, 64, NULL);
+    advance_us(10000);
+    host_trace_free(block, NULL);
+    HOST_TEST_CHECK(lifetimes()[alloc_lifetime_bucket(9)] == 1);
+
+    // Lives 2 s, across the first wrap of the 32-bit microsecond ticker.
+    advance_us(0x100000000ULL - 1000000 - us_ticker_read());
+    host_trace_malloc(block, 64, NULL);
+    advance_us(2000000);
+    HOST_TEST_CHECK(us_ticker_read() == 1000000);
+    host_trace_free(block, NULL);
+    HOST_TEST_CHECK(lifetimes()[alloc_lifetime_bucket(1953)] == 1);
+
+    // Lives 3 hours, across two more wraps, with other blocks coming and
+    // going every half hour.
+    host_trace_malloc(block, 64, NULL);
+
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        advance_us(30ULL * 60 * 1000000);
+        host_trace_malloc((void *) 0x20002000, 16, NULL);
+        host_trace_free((void *) 0x20002000, NULL);
+    }
+
+    host_trace_free(block, NULL);
+    HOST_TEST_CHECK(lifetimes()[ALLOC_LIFETIMES - 1] == 1);
+
+    uint32_t freed = 0;
+
+    for (uint32_t b = 0; b < ALLOC_LIFETIMES; b++) freed += lifetimes()[b];
+
+    HOST_TEST_CHECK(freed == 3);
+
+    return 0;
+}
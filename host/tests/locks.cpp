@@ -0,0 +1,97 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Every kernel lock a report takes is accounted for, in the
+ *          scheduler latency histograms' report count; the stack sampler
+ *          keeps a thread's samples across samples that skip it.
+ */
+
+// For report_lock_count, print_heap_info() and stack_sampler_slot(),
+// which are static.
+#include "../../mbed_memory_status.cpp"
+
+#include "host_test.h"
+
+// Each report lock counts report_lock_count up twice.
+static void check_locks_counted(void (*report)(void))
+{
+    uint32_t locks   = host_kernel_lock_count();
+    uint32_t counted = report_lock_count;
+
+    report();
+
+    HOST_TEST_CHECK(host_kernel_lock_count() > locks);
+    HOST_TEST_CHECK(report_lock_count - counted == 2 * (host_kernel_lock_count() - locks));
+    HOST_TEST_CHECK(0 == host_kernel_lock_depth());
+
+    host_output_clear();
+}
+
+int main(void)
+{
+    host_thread_config_t config = host_thread_config_t();
+
+    config.name       = "main";
+    config.entry      = 0x00012345;
+    config.stack_size = 0x0400;
+    config.stack_used = 0x0060;
+
+    void * main_thread = host_thread_create(&config);
+
+    config.name       = "worker";
+    config.entry      = 0x000123A1;
+    config.stack_size = 0x0200;
+    config.stack_used = 0x0020;
+
+    void * worker = host_thread_create(&config);
+
+    host_thread_switch(main_thread);
+    host_thread_set_depth(worker, 0x18);
+
+    memory_status_stack_sample();
+
+    check_locks_counted(print_all_thread_info);
+    check_locks_counted(print_heap_info);
+
+    // SP outside the stack: skipped and counted, the sample kept.
+    host_thread_set_depth(worker, 0x0300);
+    memory_status_stack_sample();
+
+    const stack_sampler_slot_t * slot = stack_sampler_slot((uint32_t) (uintptr_t) worker, false);
+
+    HOST_TEST_CHECK(slot);
+    HOST_TEST_CHECK(slot->samples == 1);
+    HOST_TEST_CHECK(slot->skipped == 1);
+    HOST_TEST_CHECK(slot->max     == 0x18);
+    HOST_TEST_CHECK(0 == host_kernel_lock_depth());
+
+    host_thread_set_depth(worker, 0x30);
+    memory_status_stack_sample();
+
+    HOST_TEST_CHECK(slot->samples == 2);
+    HOST_TEST_CHECK(slot->max     == 0x30);
+    HOST_TEST_CHECK(slot->depth_sketch.count == 2);
+
+    return 0;
+}
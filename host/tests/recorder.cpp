@@ -0,0 +1,86 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: The flight recorder's ring after resets at the points
+ *          memory_status_record() can be interrupted.
+ */
+
+// For recorder, recorder_header(), which are static.
+#include "../../mbed_memory_status.cpp"
+
+#include "host_test.h"
+
+static void record(uint32_t first, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) memory_status_record(first + i);
+}
+
+// As if the reset came after the last sample, before its header's CRC.
+static void lose_last_header(void)
+{
+    recorder_header()->crc ^= 1;
+}
+
+// As if it came while the last sample was being written.
+static void lose_last_sample(void)
+{
+    recorder_header_t * current = recorder_header();
+
+    lose_last_header();
+
+    recorder.samples[recorder_header()->head].crc ^= 1;
+
+    HOST_TEST_CHECK(current != recorder_header());
+}
+
+int main(void)
+{
+    record(0x100, 3);
+    memory_status_recorder_dump();
+    host_test_print("three samples");
+
+    record(0x200, 3);
+    lose_last_header();
+    memory_status_recorder_dump();
+    host_test_print("reset before the header");
+
+    record(0x300, 3);
+    lose_last_sample();
+    memory_status_recorder_dump();
+    host_test_print("reset during the sample");
+
+    record(0x400, FLIGHT_RECORDER_SAMPLES + 2);
+    lose_last_header();
+    memory_status_recorder_dump();
+    host_test_print("full ring, reset before the header");
+
+    // Both headers gone: nothing to trust.
+    record(0x500, 2);
+    recorder.headers[0].crc ^= 1;
+    recorder.headers[1].crc ^= 1;
+    HOST_TEST_CHECK(0 == memory_status_recorder_dump());
+    host_test_print("no header");
+
+    return 0;
+}
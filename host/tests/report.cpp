@@ -0,0 +1,109 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: The plain report, the same program for every RTOS backend.
+ */
+
+#include "mbed.h"
+#include "mbed_memory_status.h"
+
+#include "host_test.h"
+
+#if defined (MBED_CONF_RTOS_PRESENT)
+#include "cmsis_os.h"
+
+static void create_threads(void)
+{
+    host_thread_config_t config = host_thread_config_t();
+
+    config.name       = "main";
+    config.entry      = 0x00012345;
+    config.stack_size = 0x1000;
+    config.stack_used = 0x0340;
+
+    void * main_thread = host_thread_create(&config);
+
+    config.name       = "worker";
+    config.entry      = 0x000123A1;
+    config.stack_size = 0x0800;
+    config.stack_used = 0x0124;
+    config.priority   = 1;
+#if osCMSIS < 0x20000U
+    config.os_stack   = true; // Goes through _osThreadGetInfo().
+#endif
+
+    void * worker = host_thread_create(&config);
+
+    config.name       = "idle";
+    config.entry      = 0x00011001;
+    config.stack_size = 0x0200;
+    config.stack_used = 0x0048;
+    config.priority   = 0;
+    config.os_stack   = false;
+
+    void * idle = host_thread_create(&config);
+
+    host_thread_block(worker, true);
+    host_thread_block(idle, false);
+    host_thread_switch(main_thread);
+}
+#endif
+
+int main(void)
+{
+    host_heap_stats.current_size   = 0x0520;
+    host_heap_stats.max_size       = 0x0C40;
+    host_heap_stats.total_size     = 0x4000;
+    host_heap_stats.alloc_cnt      = 17;
+    host_heap_stats.alloc_fail_cnt = 1;
+
+#if defined (MBED_CONF_RTOS_PRESENT)
+    create_threads();
+
+    print_current_thread_id();
+    host_test_print("current thread");
+
+    print_all_thread_info();
+    host_test_print("threads");
+#endif
+
+    print_heap_and_isr_stack_info();
+    host_test_print("heap and isr stack");
+
+    memory_status_snapshot_t snapshot;
+
+    memory_status_snapshot(&snapshot);
+
+#if defined (MBED_CONF_RTOS_PRESENT)
+    HOST_TEST_CHECK(3 == snapshot.thread_count);
+    HOST_TEST_CHECK(3 == snapshot.thread_total);
+#else
+    HOST_TEST_CHECK(0 == snapshot.thread_count);
+#endif
+
+    HOST_TEST_CHECK(0x0520 == snapshot.heap.current_size);
+    HOST_TEST_CHECK(HOST_HEAP_START == snapshot.heap.start);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: The PC sampler driven through the RTT commands,
+ *          memory_status_sampler_read() into an unaligned buffer, and the
+ *          bounds on the dump command.
+ */
+
+#include <string.h>
+
+#include "mbed.h"
+#include "mbed_memory_status.h"
+#include "RTT/SEGGER_RTT.h"
+
+#include "host_test.h"
+
+// What the debug probe does when a line is typed into RTT Viewer. The
+// down-buffer is small, so the target polls in between.
+static void rtt_type(const char * line)
+{
+    SEGGER_RTT_Init();
+
+    SEGGER_RTT_BUFFER_DOWN * down = &_SEGGER_RTT.aDown[0];
+
+    for (; *line; line++)
+    {
+        if ((down->WrOff + 1) % down->SizeOfBuffer == down->RdOff) poll_memory_status_commands();
+
+        down->pBuffer[down->WrOff] = *line;
+        down->WrOff = (down->WrOff + 1) % down->SizeOfBuffer;
+    }
+
+    poll_memory_status_commands();
+}
+
+static void sample(uint32_t pc, uint32_t count)
+{
+    host_set_exception_pc(pc);
+
+    for (uint32_t i = 0; i < count; i++) host_ticker_fire();
+}
+
+int main(void)
+{
+    host_thread_config_t config = host_thread_config_t();
+
+    config.name       = "main";
+    config.entry      = 0x00012345;
+    config.stack_size = 0x0400;
+    config.stack_used = 0x0060;
+
+    void * main_thread = host_thread_create(&config);
+
+    config.name       = "worker";
+    config.entry      = 0x000123A1;
+    config.stack_size = 0x0200;
+    config.stack_used = 0x0020;
+
+    void * worker = host_thread_create(&config);
+
+    rtt_type("sampler start 1000\n");
+
+    host_thread_switch(main_thread);
+    sample(0x00012351, 3);
+
+    host_thread_switch(worker);
+    sample(0x000123B7, 2);
+
+    rtt_type("sampler stop\n");
+    host_test_print("sampler stop");
+
+    rtt_type("sampler\n");
+    host_test_print("usage");
+
+    // Cut short to DUMP_MAX_LENGTH (0x40 in this build).
+    uint32_t * words = (uint32_t *) host_ram(0x200C0000);
+
+    for (uint32_t i = 0; i < 32; i++) words[i] = 0xA5000000 | i;
+
+    rtt_type("dump 200C0000 1000\n");
+    host_test_print("dump clamped");
+
+    // Outside RAM (there is no flash on the host), and running past its end.
+    rtt_type("dump 00010000 10\n");
+    rtt_type("dump 200FFFF8 10\n");
+    rtt_type("dump FFFFFFF0 20\n");
+    host_test_print("dump rejected");
+
+    // Packet buffers need not be aligned.
+    rtt_type("sampler start 50\n");
+    sample(0x000123B7, 1);
+    memory_status_sampler_stop();
+
+    uint8_t                   packet[1 + 3 * sizeof(memory_status_pc_sample_t)];
+    memory_status_pc_sample_t records[3];
+
+    HOST_TEST_CHECK(2 * sizeof(records[0]) == memory_status_sampler_read(packet + 1, sizeof(packet) - 1));
+
+    memcpy(records, packet + 1, 2 * sizeof(records[0]));
+
+    HOST_TEST_CHECK(0          == records[0].thread);
+    HOST_TEST_CHECK(50         == records[0].pc);
+    HOST_TEST_CHECK(0x000123B0 == records[1].pc);
+    HOST_TEST_CHECK(1          == records[1].count);
+
+    return 0;
+}
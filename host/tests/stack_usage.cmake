@@ -0,0 +1,51 @@
+# Reads the -fstack-usage output for mbed_memory_status.cpp in each of
+# OBJECTS (the objects of the libraries checked, separated by |) and fails
+# if any function's frame is not static, or is larger than BUDGET bytes.
+
+string(REPLACE "|" ";" objects "${OBJECTS}")
+
+set(checked 0)
+set(failures "")
+
+foreach(object ${objects})
+    if(NOT object MATCHES "mbed_memory_status\\.cpp\\.o(bj)?$")
+        continue()
+    endif()
+
+    string(REGEX REPLACE "\\.o(bj)?$" ".su" su "${object}")
+
+    if(NOT EXISTS "${su}")
+        message(FATAL_ERROR "${su} missing, is -fstack-usage set?")
+    endif()
+
+    file(STRINGS "${su}" lines)
+
+    foreach(line ${lines})
+        # <file>:<line>:<column>:<function>\t<bytes>\t<qualifiers>
+        if(NOT line MATCHES "^(.*)\t([0-9]+)\t(.*)$")
+            message(FATAL_ERROR "${su}: cannot parse '${line}'")
+        endif()
+
+        set(function "${CMAKE_MATCH_1}")
+        set(bytes    "${CMAKE_MATCH_2}")
+        set(kind     "${CMAKE_MATCH_3}")
+
+        if(NOT kind STREQUAL "static")
+            string(APPEND failures "${function}: ${kind}\n")
+        elseif(bytes GREATER BUDGET)
+            string(APPEND failures "${function}: ${bytes} bytes, budget ${BUDGET}\n")
+        endif()
+
+        math(EXPR checked "${checked} + 1")
+    endforeach()
+endforeach()
+
+if(checked EQUAL 0)
+    message(FATAL_ERROR "No stack usage found in ${OBJECTS}")
+endif()
+
+if(failures)
+    message(FATAL_ERROR "Stack frames over budget or not fixed size:\n${failures}")
+endif()
+
+message(STATUS "${checked} frames, all static and at most ${BUDGET} bytes")
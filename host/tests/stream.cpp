@@ -0,0 +1,174 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: The pull-based stream: a report read out in small packets, a
+ *          line cut short, the binary records, and output from other
+ *          threads and interrupt handlers while a line is being rendered.
+ */
+
+// For stream_capture_begin() / _end(), which are static.
+#include "../../mbed_memory_status.cpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "host_test.h"
+
+static void print_stream(const char * title, uint32_t packet_size)
+{
+    char packet[16];
+    char previous = '\0';
+
+    printf("-- %s --\n", title);
+
+    memory_status_stream_begin(MEMORY_STATUS_STREAM_TEXT);
+
+    for (uint32_t n; (n = memory_status_stream_read(packet, packet_size)); )
+    {
+        fwrite(packet, 1, n, stdout);
+
+        // Every line ends in \r\n, cut short or not.
+        for (uint32_t i = 0; i < n; previous = packet[i++])
+        {
+            if (packet[i] == '\n') HOST_TEST_CHECK(previous == '\r');
+        }
+    }
+}
+
+static uint32_t get_u32(const uint8_t ** in)
+{
+    const uint8_t * p = *in;
+
+    *in += 4;
+
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+// Reads the binary stream in packets of 7 bytes and checks it field by
+// field against a snapshot.
+static void check_binary_stream(void)
+{
+    static uint8_t                  stream[2048];
+    static memory_status_snapshot_t expected;
+    uint32_t                        length = 0;
+
+    memory_status_snapshot(&expected);
+    memory_status_stream_begin(MEMORY_STATUS_STREAM_BINARY);
+
+    for (uint32_t n; (n = memory_status_stream_read(&stream[length], 7)); length += n)
+    {
+        HOST_TEST_CHECK(length + 7 < sizeof(stream));
+    }
+
+    const uint8_t * in = stream;
+
+    HOST_TEST_CHECK(expected.thread_count == get_u32(&in));
+    HOST_TEST_CHECK(expected.thread_total == get_u32(&in));
+
+    for (uint32_t i = 0; i < expected.thread_count; i++)
+    {
+        const memory_status_thread_t * thread = &expected.threads[i];
+
+        HOST_TEST_CHECK(thread->stack_start == get_u32(&in));
+        HOST_TEST_CHECK(thread->stack_end   == get_u32(&in));
+        HOST_TEST_CHECK(thread->stack_size  == get_u32(&in));
+        HOST_TEST_CHECK(thread->stack_used  == get_u32(&in));
+        HOST_TEST_CHECK(thread->id          == get_u32(&in));
+        HOST_TEST_CHECK(thread->entry       == get_u32(&in));
+        HOST_TEST_CHECK(thread->state       == (int32_t) get_u32(&in));
+        HOST_TEST_CHECK(thread->priority    == (int32_t) get_u32(&in));
+
+        uint32_t name_length = *in++;
+
+        HOST_TEST_CHECK(name_length == (strlen(thread->name) < 64 ? strlen(thread->name) : 64));
+        HOST_TEST_CHECK(0 == memcmp(in, thread->name, name_length));
+
+        in += name_length;
+    }
+
+    HOST_TEST_CHECK(expected.heap.start          == get_u32(&in));
+    HOST_TEST_CHECK(expected.heap.end            == get_u32(&in));
+    HOST_TEST_CHECK(expected.heap.size           == get_u32(&in));
+    HOST_TEST_CHECK(expected.heap.current_size   == get_u32(&in));
+    HOST_TEST_CHECK(expected.heap.max_size       == get_u32(&in));
+    HOST_TEST_CHECK(expected.heap.total_size     == get_u32(&in));
+    HOST_TEST_CHECK(expected.heap.alloc_cnt      == get_u32(&in));
+    HOST_TEST_CHECK(expected.heap.alloc_fail_cnt == get_u32(&in));
+
+    HOST_TEST_CHECK(expected.isr_stack.start == get_u32(&in));
+    HOST_TEST_CHECK(expected.isr_stack.end   == get_u32(&in));
+    HOST_TEST_CHECK(expected.isr_stack.size  == get_u32(&in));
+    HOST_TEST_CHECK(expected.isr_stack.used  == get_u32(&in));
+
+    HOST_TEST_CHECK(in == stream + length);
+}
+
+int main(void)
+{
+    host_thread_config_t config = host_thread_config_t();
+
+    config.name       = "main";
+    config.entry      = 0x00012345;
+    config.stack_size = 0x0400;
+    config.stack_used = 0x0060;
+
+    void * main_thread = host_thread_create(&config);
+
+    config.name       = "a_worker_thread_with_a_name_long_enough_to_run_past_the_end_of_one_stream_line_of_one_hundred_and_sixty_characters";
+    config.entry      = 0x000123A1;
+    config.stack_size = 0x0200;
+    config.stack_used = 0x0020;
+
+    void * worker = host_thread_create(&config);
+
+    host_thread_switch(main_thread);
+
+    print_stream("text", 7);
+    HOST_TEST_CHECK(0 == host_output_length());
+
+    check_binary_stream();
+
+    // The worker preempts the rendering thread and prints; then an
+    // interrupt handler does. Neither ends up in the line.
+    stream_capture_begin();
+
+    host_thread_switch(worker);
+    DPL("worker\r\n");
+
+    host_set_ipsr(16);
+    DPL("isr\r\n");
+    host_set_ipsr(0);
+
+    host_thread_switch(main_thread);
+    DPL("main\r\n");
+
+    stream_capture_end();
+
+    HOST_TEST_CHECK(6 == stream_line_length);
+    HOST_TEST_CHECK(0 == memcmp(stream_line, "main\r\n", 6));
+
+    host_test_print("other threads");
+
+    return 0;
+}
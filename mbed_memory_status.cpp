@@ -40,6 +40,8 @@
 
 #include "mbed.h"
 
+#include "mbed_memory_status.h"
+
 // Critical sections header file renamed in mbed OS 5.4 release
 // See: https://github.com/ARMmbed/mbed-os/commit/aff49d8d1e3b5d4dc18286b0510336c36ae9603c
 
@@ -59,6 +61,54 @@
 #warning MBED_STACK_STATS_ENABLED != 1, so there will be no stack usage measurements.
 #endif
 
+// RTOS backend, decided once here so the rest of the file only has to
+// test MEMORY_STATUS_RTOS.
+//
+// What the reports need from the RTOS is a traits type per backend
+// (rtx4_traits, rtx5_traits, no_rtos_traits), selected as rtos_traits;
+// the report core is written against that. Only the selected backend's
+// traits are defined, as an mbed build only ships that RTOS's headers.
+// The RTOS hooks (EvrRtx*() overrides, --wrap wrappers) stay behind
+// MEMORY_STATUS_RTOS, being link-level symbols that must be defined or
+// absent per build. The host build (host/) builds and tests every backend
+// side by side.
+
+#define MEMORY_STATUS_RTOS_NONE  0
+#define MEMORY_STATUS_RTOS_RTX4  1 // CMSIS-RTOS 1, mbed OS 5.4 and lower
+#define MEMORY_STATUS_RTOS_RTX5  2 // CMSIS-RTOS 2, mbed OS 5.5 and higher
+
+#if (defined (MBED_CONF_RTOS_PRESENT) && (MBED_CONF_RTOS_PRESENT != 0))
+#include "cmsis_os.h"
+
+// cmsis_os.h provides some useful defines:
+//
+// For mbed OS 5.4 and lower,  osCMSIS == 0x10002U (see: rtos/rtx/TARGET_CORTEX_M)
+// For mbed OS 5.5 and higher, osCMSIS == 0x20001U (see: rtos/TARGET_CORTEX/rtx{4|5})
+//
+// Starting in mbed OS 5.5, a new RTOS layer was introduced with a different API.
+
+#if (osCMSIS < 0x20000U)
+    // Temporarily #undef NULL or the compiler complains about previous def.
+    #undef NULL
+    #include "rt_TypeDef.h"
+    #define MEMORY_STATUS_RTOS   MEMORY_STATUS_RTOS_RTX4
+#else
+    #include "rtx_lib.h"
+    #define MEMORY_STATUS_RTOS   MEMORY_STATUS_RTOS_RTX5
+#endif
+#else
+    #define MEMORY_STATUS_RTOS   MEMORY_STATUS_RTOS_NONE
+#endif
+
+// RTX5's thread events, whose EvrRtx*() hooks this file overrides. With
+// EVR_RTX_DISABLE, or OS_EVR_THREAD off in RTX_Config.h, rtx_evr.h turns
+// the hook names into empty macros, so they must not be defined then.
+#if (MEMORY_STATUS_RTOS == MEMORY_STATUS_RTOS_RTX5) && !defined (EVR_RTX_DISABLE) && (OS_EVR_THREAD != 0)
+    #define MEMORY_STATUS_THREAD_EVENTS  1
+#else
+    #define MEMORY_STATUS_THREAD_EVENTS  0
+#endif
+
 #ifndef DEBUG_ISR_STACK_USAGE
 #define DEBUG_ISR_STACK_USAGE  0
 #endif
@@ -67,9 +117,108 @@
 #define DEBUG_MEMORY_CONTENTS  0
 #endif
 
+#ifndef DEBUG_RTT_COMMANDS
+#define DEBUG_RTT_COMMANDS     0
+#endif
+
+#ifndef DEBUG_SELF_COST
+#define DEBUG_SELF_COST        0
+#endif
+
+#ifndef DEBUG_STREAM
+#define DEBUG_STREAM           0
+#endif
+
+#ifndef DEBUG_FLIGHT_RECORDER
+#define DEBUG_FLIGHT_RECORDER  0
+#endif
+
+#ifndef DEBUG_FAULT_DUMP
+#define DEBUG_FAULT_DUMP       0
+#endif
+
+#ifndef DEBUG_THREAD_CPU_TIME
+#define DEBUG_THREAD_CPU_TIME  0
+#endif
+
+#ifndef DEBUG_SCHED_LATENCY
+#define DEBUG_SCHED_LATENCY    0
+#endif
+
+#ifndef DEBUG_CONTENTION
+#define DEBUG_CONTENTION       0
+#endif
+
+#ifndef DEBUG_PC_SAMPLER
+#define DEBUG_PC_SAMPLER       0
+#endif
+
+#ifndef DEBUG_STACK_SAMPLER
+#define DEBUG_STACK_SAMPLER    0
+#endif
+
+#ifndef DEBUG_QUANTILES
+#define DEBUG_QUANTILES        0
+#endif
+
+// Each of these also checks its own requirements further down, but only
+// inside the RTOS part of the file, which is not compiled without an RTOS.
+#if MEMORY_STATUS_RTOS == MEMORY_STATUS_RTOS_NONE
+#if DEBUG_STACK_SAMPLER || DEBUG_QUANTILES
+#error "DEBUG_STACK_SAMPLER and DEBUG_QUANTILES need CMSIS-RTOS 2 (mbed OS 5.5 and up)."
+#endif
+#endif
+
+#ifndef DEBUG_ALLOC_LIFETIME
+#define DEBUG_ALLOC_LIFETIME   0
+#endif
+
+#ifndef DEBUG_ALLOC_LATENCY
+#define DEBUG_ALLOC_LATENCY    0
+#endif
+
+#ifndef DEBUG_ALLOC_TAGS
+#define DEBUG_ALLOC_TAGS       0
+#endif
+
+#ifndef DEBUG_ALLOC_QUOTAS
+#define DEBUG_ALLOC_QUOTAS     0
+#endif
+
+// Outputs can be chosen from mbed_app.json or the command line, so that the
+// file itself never has to be edited (e.g. when building against stubs).
+#ifndef OUTPUT_SERIAL
 #define OUTPUT_SERIAL          1
+#endif
+
+#ifndef OUTPUT_RTT
 #define OUTPUT_RTT             0
+#endif
+
+#ifndef OUTPUT_SWO
 #define OUTPUT_SWO             0
+#endif
+
+// Wrap every output line in a framed record (see "Framing" below), so that
+// a host can detect lost and truncated lines on lossy outputs.
+#ifndef OUTPUT_FRAMING
+#define OUTPUT_FRAMING         0
+#endif
+
+// Set by print_fault_memory_status(). From then on the outputs avoid
+// critical sections and locks, which may not be usable in a fault handler.
+static volatile bool fault_mode = false;
+
+// Output sinks
+//
+// Each output is a sink, a type with a static write(). A disabled output's
+// sink is null_sink, and output_sinks (below) strings them together at
+// compile time, so dispatch is inlined and a disabled output compiles to
+// nothing.
+struct null_sink
+{
+    static void write(const char *, uint32_t) {}
+};
 
 #if DEBUG_ISR_STACK_USAGE
 #include "compiler_abstraction.h"
@@ -85,7 +234,7 @@ extern uint32_t __StackTop;
 void fill_isr_stack_with_canary(void)
 {
     uint32_t * bottom = &__StackLimit;
-    uint32_t * top    = (uint32_t *) GET_SP();
+    uint32_t * top    = (uint32_t *) (uintptr_t) GET_SP();
 
     for (; bottom < top; bottom++)
     {
@@ -109,30 +258,39 @@ static void output_serial_init(void)
     }
 }
 
-static void output_serial_print_label(const char * label)
+struct serial_sink
 {
+    static void write(const char * data, uint32_t length)
+    {
 #if MBED_VERSION < 50902
-    // After mbed OS 5.9.2, this locks up the system.
-    core_util_critical_section_enter();
+        // After mbed OS 5.9.2, this locks up the system.
+        if (!fault_mode) core_util_critical_section_enter();
 #endif
 
-    output_serial_init();
+        output_serial_init();
 
-    while (*label) serial_putc(&stdio_uart, *label++);
+        while (length--) serial_putc(&stdio_uart, *data++);
 
 #if MBED_VERSION < 50902
-    core_util_critical_section_exit();
+        if (!fault_mode) core_util_critical_section_exit();
 #endif
-}
+    }
+};
+#else
+typedef null_sink serial_sink;
 #endif // OUTPUT_SERIAL && DEVICE_SERIAL
 
-#if OUTPUT_RTT
+#if OUTPUT_RTT || DEBUG_RTT_COMMANDS
 #include "RTT/SEGGER_RTT.h"
 
 enum
 {
-    DEFAULT_RTT_UP_BUFFER = 0
+    DEFAULT_RTT_UP_BUFFER   = 0,
+    DEFAULT_RTT_DOWN_BUFFER = 0
 };
+#endif
+
+#if OUTPUT_RTT
 
 static void output_rtt_init(void)
 {
@@ -146,11 +304,24 @@ static void output_rtt_init(void)
     }
 }
 
-static void output_rtt_print_label(const char * label)
+struct rtt_sink
 {
-    output_rtt_init();
-    SEGGER_RTT_WriteString(DEFAULT_RTT_UP_BUFFER, label);
-}
+    static void write(const char * data, uint32_t length)
+    {
+        output_rtt_init();
+
+        if (fault_mode)
+        {
+            SEGGER_RTT_WriteNoLock(DEFAULT_RTT_UP_BUFFER, data, length);
+        }
+        else
+        {
+            SEGGER_RTT_Write(DEFAULT_RTT_UP_BUFFER, data, length);
+        }
+    }
+};
+#else
+typedef null_sink rtt_sink;
 #endif // OUTPUT_RTT
 
 #if OUTPUT_SWO
@@ -178,310 +349,4171 @@ static void output_swo_init(void)
     }
 }
 
-static void output_swo_print_label(const char * label)
+struct swo_sink
 {
-    output_swo_init();
-    while (*label) ITM_SendChar(*label++);
-}
+    static void write(const char * data, uint32_t length)
+    {
+        output_swo_init();
+        while (length--) ITM_SendChar(*data++);
+    }
+};
+#else
+typedef null_sink swo_sink;
 #endif // OUTPUT_SWO
 
-static void nway_print_label(const char * label)
+#if DEBUG_SELF_COST
+// Each report measures what it cost: total time, time with the kernel
+// locked, and bytes written to / time spent in each output. The DWT cycle
+// counter is used where the core has one (Cortex-M3 and up), us_ticker
+// otherwise.
+
+#if defined (DWT_CTRL_CYCCNTENA_Msk)
+static uint32_t cost_now(void)
 {
-#if OUTPUT_SERIAL
-    output_serial_print_label(label);
-#endif
+    static int initialized = 0;
 
-#if OUTPUT_RTT
-    output_rtt_print_label(label);
-#endif
+    if (!initialized)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
 
-#if OUTPUT_SWO
-    output_swo_print_label(label);
-#endif
-}
+        initialized = 1;
+    }
 
-static const char HEX[] = "0123456789ABCDEF";
+    return DWT->CYCCNT;
+}
 
-static void debug_print_u32(uint32_t u32)
+static uint32_t cost_ticks_per_second(void)
 {
-    char output[9] = {0};
-
-    // Always printed as big endian.
-    output[0] = HEX[(((uint32_t) u32 & 0xf0000000) >> 28)];
-    output[1] = HEX[(((uint32_t) u32 & 0x0f000000) >> 24)];
-    output[2] = HEX[(((uint32_t) u32 & 0x00f00000) >> 20)];
-    output[3] = HEX[(((uint32_t) u32 & 0x000f0000) >> 16)];
-    output[4] = HEX[(((uint32_t) u32 & 0x0000f000) >> 12)];
-    output[5] = HEX[(((uint32_t) u32 & 0x00000f00) >>  8)];
-    output[6] = HEX[(((uint32_t) u32 & 0x000000f0) >>  4)];
-    output[7] = HEX[(((uint32_t) u32 & 0x0000000f) >>  0)];
+    return SystemCoreClock;
+}
+#else
+#include "hal/us_ticker_api.h"
 
-    nway_print_label(output);
+static uint32_t cost_now(void)
+{
+    return us_ticker_read();
 }
 
-static void debug_print_pointer(const void * pointer)
+static uint32_t cost_ticks_per_second(void)
 {
-    debug_print_u32((uint32_t) pointer);
+    return 1000000;
 }
+#endif
 
-#define DPL(X) nway_print_label((X))
+static memory_status_cost_t cost_current;
+static memory_status_cost_t cost_last;
+static uint32_t             cost_start;
+static uint32_t             cost_lock_start;
+static uint32_t             cost_depth = 0;
+#endif // DEBUG_SELF_COST
 
-#if (defined (MBED_CONF_RTOS_PRESENT) && (MBED_CONF_RTOS_PRESENT != 0))
-#include "cmsis_os.h"
+// Sink, with every write charged to its Ticks and Bytes in the self cost.
+template <class Sink, uint32_t memory_status_cost_t::*Ticks, uint32_t memory_status_cost_t::*Bytes>
+struct costed_sink
+{
+    static void write(const char * data, uint32_t length)
+    {
+#if DEBUG_SELF_COST
+        uint32_t start = cost_now();
 
-// cmsis_os.h provides some useful defines:
-//
-// For mbed OS 5.4 and lower,  osCMSIS == 0x10002U (see: rtos/rtx/TARGET_CORTEX_M)
-// For mbed OS 5.5 and higher, osCMSIS == 0x20001U (see: rtos/TARGET_CORTEX/rtx{4|5})
-//
-// Starting in mbed OS 5.5, a new RTOS layer was introduced with a different API.
+        Sink::write(data, length);
 
-#if (osCMSIS < 0x20000U)
-    // Temporarily #undef NULL or the compiler complains about previous def.
-    #undef NULL
-    #include "rt_TypeDef.h"
+        cost_current.*Ticks += cost_now() - start;
+        cost_current.*Bytes += length;
 #else
-    #include "rtx_lib.h"
-    // #include <stdlib.h>  // Include if you need malloc() / free() below. (probably better for non-C99 compilers)
+        Sink::write(data, length);
 #endif
+    }
+};
 
-#if (osCMSIS < 0x20000U)
-
-// No public forward declaration for this.
-extern "C" P_TCB rt_tid2ptcb (osThreadId thread_id);
+// A disabled output costs nothing, not even the clock reads.
+template <uint32_t memory_status_cost_t::*Ticks, uint32_t memory_status_cost_t::*Bytes>
+struct costed_sink<null_sink, Ticks, Bytes> : null_sink {};
 
-static void print_thread_info(osThreadId threadId)
+// Fixed arity rather than a variadic pack, as this is C++98; unused
+// places are null_sink.
+template <class First, class Second = null_sink, class Third = null_sink>
+struct sink_pack
 {
-    if (!threadId) return;
+    static void write(const char * data, uint32_t length)
+    {
+        First::write(data, length);
+        Second::write(data, length);
+        Third::write(data, length);
+    }
+};
 
-    osEvent event;
+typedef sink_pack<
+    costed_sink<serial_sink, &memory_status_cost_t::serial_ticks, &memory_status_cost_t::serial_bytes>,
+    costed_sink<rtt_sink,    &memory_status_cost_t::rtt_ticks,    &memory_status_cost_t::rtt_bytes>,
+    costed_sink<swo_sink,    &memory_status_cost_t::swo_ticks,    &memory_status_cost_t::swo_bytes> > output_sinks;
 
-    P_TCB tcb = rt_tid2ptcb(threadId);
+// Reports can nest (e.g. the RTT "threads" command), only the outermost
+// one is measured.
+static void cost_begin(void)
+{
+#if DEBUG_SELF_COST
+    if (cost_depth++) return;
 
-    DPL("    stack ( start: ");
-    debug_print_pointer(tcb->stack);
+    memset(&cost_current, 0, sizeof(cost_current));
+    cost_current.ticks_per_second = cost_ticks_per_second();
+    cost_start = cost_now();
+#endif
+}
+
+static inline void cost_lock_begin(void)
+{
+#if DEBUG_SELF_COST
+    cost_lock_start = cost_now();
+#endif
+}
 
-    event = _osThreadGetInfo(threadId, osThreadInfoStackSize);
+static inline void cost_lock_end(void)
+{
+#if DEBUG_SELF_COST
+    cost_current.kernel_locked_ticks += cost_now() - cost_lock_start;
+#endif
+}
 
-    DPL(" end: ");
-    debug_print_pointer(((uint8_t *) tcb->stack + event.value.v)); // (tcb->priv_stack)));
+static void nway_write(const char * data, uint32_t length)
+{
+    output_sinks::write(data, length);
+}
 
-    DPL(" size: ");
-    debug_print_u32(event.value.v);
+#if OUTPUT_FRAMING || DEBUG_FLIGHT_RECORDER
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF).
+static uint16_t crc16_ccitt(const uint8_t * data, uint32_t length)
+{
+    // Nibble table, small enough for flash and needs no hardware multiply.
+    static const uint16_t CRC16_NIBBLE[16] =
+    {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+    };
 
-    event = _osThreadGetInfo(threadId, osThreadInfoStackMax);
-    DPL(" used: ");
-    debug_print_u32(event.value.v);
+    uint16_t crc = 0xFFFF;
 
+    while (length--)
+    {
+        crc = (uint16_t) ((crc << 4) ^ CRC16_NIBBLE[(crc >> 12) ^ (*data >> 4)]);
+        crc = (uint16_t) ((crc << 4) ^ CRC16_NIBBLE[(crc >> 12) ^ (*data & 0x0F)]);
+        data++;
+    }
 
-    DPL(" ) ");
+    return crc;
+}
+#endif
 
-    DPL("thread ( id: ");
-    debug_print_pointer(threadId);
+#if OUTPUT_FRAMING
+// Framing
+//
+// Each output line (or each FRAME_PAYLOAD_SIZE bytes of a longer one)
+// becomes one record:
+//
+//   COBS( seq_lo seq_hi payload... crc_lo crc_hi ) 0x00
+//
+// seq is a 16-bit record counter, crc is CRC-16/CCITT-FALSE over seq and
+// payload. COBS removes every 0x00 from the record, so 0x00 only ever
+// appears as the delimiter and a receiver can resynchronize after any
+// loss. tools/frame_decode.c turns the stream back into text and counts
+// lost and corrupted records.
 
-    event = _osThreadGetInfo(threadId, osThreadInfoEntry);
-    DPL(" entry: ");
-    debug_print_pointer(event.value.p);
+enum
+{
+    FRAME_PAYLOAD_SIZE = 160,
+    FRAME_RECORD_SIZE  = 2 + FRAME_PAYLOAD_SIZE + 2,
+    FRAME_ENCODED_SIZE = FRAME_RECORD_SIZE + (FRAME_RECORD_SIZE / 254) + 2
+};
 
-    DPL(" )\r\n");
-}
+static uint8_t           frame_record[FRAME_RECORD_SIZE];
+static uint8_t           frame_encoded[FRAME_ENCODED_SIZE];
+static volatile uint32_t frame_length   = 2;
+static uint16_t          frame_sequence = 0;
 
-void print_all_thread_info(void)
+static uint32_t cobs_encode(const uint8_t * input, uint32_t length, uint8_t * output)
 {
-    osThreadEnumId enumId   = _osThreadsEnumStart();
-    osThreadId     threadId = (osThreadId) NULL; // Can't use nullptr yet because mbed doesn't support C++11.
+    uint8_t * code_at = output;
+    uint8_t * out     = output + 1;
+    uint8_t   code    = 1;
 
-    while ((threadId = _osThreadEnumNext(enumId)))
+    while (length--)
     {
-        print_thread_info(threadId);
+        if (*input)
+        {
+            *out++ = *input;
+            code++;
+        }
+
+        if (!*input || code == 0xFF)
+        {
+            *code_at = code;
+            code     = 1;
+            code_at  = out++;
+        }
+
+        input++;
     }
 
-    _osThreadEnumFree(enumId);
-}
+    *code_at = code;
+    *out++   = 0x00;
 
-#else
+    return (uint32_t) (out - output);
+}
 
-static void print_thread_info(osThreadId threadId)
+static void frame_flush(void)
 {
-    // Refs: rtx_lib.h - #define os_thread_t osRtxThread_t
-    //       rtx_os.h  - typedef struct osRtxThread_s { } osRtxThread_t
+    uint32_t length = frame_length;
 
-    if (!threadId) return;
+    if (length <= 2) return;
 
-    os_thread_t * tcb = (os_thread_t *) threadId;
+    if (length > 2 + FRAME_PAYLOAD_SIZE) length = 2 + FRAME_PAYLOAD_SIZE;
 
-    uint32_t stackSize = osThreadGetStackSize(threadId);
-    uint32_t stackUsed = osThreadGetStackSpace(threadId);
+    frame_length = 2;
 
-    DPL("    stack ( start: ");
-    debug_print_pointer(tcb->stack_mem);
+    frame_record[0] = (uint8_t) (frame_sequence);
+    frame_record[1] = (uint8_t) (frame_sequence >> 8);
 
-    DPL(" end: ");
-    debug_print_pointer((uint8_t *) tcb->stack_mem + stackSize);
+    uint16_t crc = crc16_ccitt(frame_record, length);
 
-    DPL(" size: ");
-    debug_print_u32(stackSize);
+    frame_record[length++] = (uint8_t) (crc);
+    frame_record[length++] = (uint8_t) (crc >> 8);
 
-    DPL(" used: ");
-    debug_print_u32(stackSize - stackUsed);
+    nway_write((const char *) frame_encoded, cobs_encode(frame_record, length, frame_encoded));
 
-    DPL(" ) ");
+    frame_sequence++;
+}
 
-    DPL("thread ( id: ");
-    debug_print_pointer(threadId);
+// Every store goes through an index that was checked against the payload
+// size, so a writer preempting another one (two threads printing at once)
+// can mix their text in a record, as it would without framing, but never
+// write past the record.
+static void frame_append(const char * label)
+{
+    while (*label)
+    {
+        char     c = *label++;
+        uint32_t index;
 
-    DPL(" entry: ");
-    debug_print_u32(tcb->thread_addr);
+        while ((index = frame_length) >= 2 + FRAME_PAYLOAD_SIZE) frame_flush();
 
-    DPL(" name: ");
-    DPL(osThreadGetName(threadId) ? osThreadGetName(threadId) : "unknown");
+        frame_record[index] = (uint8_t) c;
+        frame_length        = index + 1;
 
-    DPL(" )\r\n");
+        if (c == '\n' || index + 1 >= 2 + FRAME_PAYLOAD_SIZE)
+        {
+            frame_flush();
+        }
+    }
 }
 
-void print_all_thread_info(void)
+// Drops the partial record of whatever output a fault interrupted. It may
+// be half written, and was never sent, so no sequence number goes missing.
+static void frame_reset(void)
 {
-    // Refs: mbed_stats.c - mbed_stats_stack_get_each()
-
-    uint32_t     threadCount = osThreadGetCount();
-    osThreadId_t threads[threadCount]; // g++ will throw a -Wvla on this, but it is likely ok.
+    frame_length = 2;
+}
+#endif // OUTPUT_FRAMING
 
-    // osThreadId_t * threads = malloc(sizeof(osThreadId_t) * threadCount);
-    // MBED_ASSERT(NULL != threads);
+#if DEBUG_STREAM
+// While the stream renders a line, the formatters' output is captured here
+// instead of going to the outputs. One line at a time, never the whole report.
+// Only the rendering thread's output is captured: anything another thread
+// or an interrupt handler prints meanwhile goes to the outputs as usual.
 
-    memset(threads, 0, threadCount * sizeof(osThreadId_t));
+enum
+{
+    STREAM_LINE_SIZE = 160,
+    STREAM_NAME_SIZE = 64   // Binary records: longer thread names are cut short.
+};
 
-    // This will probably only work if the number of threads remains constant
-    // (i.e. the number of thread control blocks remains constant)
-    //
-    // This is probably the case on a deterministic realtime embedded system
-    // with limited SRAM.
+static char          stream_line[STREAM_LINE_SIZE];
+static uint32_t      stream_line_length = 0;
+static volatile bool stream_capturing   = false;
+static uint32_t      stream_renderer    = 0;
 
-    osKernelLock();
+static uint32_t stream_thread_id(void)
+{
+#if MEMORY_STATUS_RTOS != MEMORY_STATUS_RTOS_NONE
+    return (uint32_t) (uintptr_t) osThreadGetId();
+#else
+    return 0;
+#endif
+}
 
-    threadCount = osThreadEnumerate(threads, threadCount);
+static bool stream_capturing_here(void)
+{
+    // IPSR first: osThreadGetId() is an SVC on CMSIS-RTOS 1.
+    return stream_capturing && !fault_mode && __get_IPSR() == 0 && stream_thread_id() == stream_renderer;
+}
 
-    for (uint32_t i = 0; i < threadCount; i++)
+static void stream_capture(const char * label)
+{
+    // Overlong lines (i.e. very long thread names) are cut short.
+    while (*label && stream_line_length < STREAM_LINE_SIZE)
     {
-        // There seems to be a Heisenbug when calling print_thread_info()
-        // inside of osKernelLock()!
-
-        // This error may appear on the serial console:
-        // mbed assertation failed: os_timer->get_tick() == svcRtxKernelGetTickCount(), file: .\mbed-os\rtos\TARGET_CORTEX\mbed_rtx_idle.c
-
-        // The RTOS seems to be asserting an idle constraint violation due
-        // to the slowness of sending data through the serial port, but it
-        // does not happen consistently.
-        print_thread_info(threads[i]);
+        stream_line[stream_line_length++] = *label++;
     }
-
-    osKernelUnlock();
-
-    // free(threads);
 }
 
-#endif
-
-void print_current_thread_id(void)
+static void stream_capture_begin(void)
 {
-    DPL("Current thread: ");
-    debug_print_pointer(osThreadGetId());
-    DPL("\r\n");
+    stream_line_length = 0;
+    stream_renderer    = stream_thread_id();
+    stream_capturing   = true;
 }
-#endif // MBED_CONF_RTOS_PRESENT
 
-#if DEBUG_MEMORY_CONTENTS
-static void print_memory_contents(const uint32_t * start, const uint32_t * end)
+static void stream_capture_end(void)
 {
-    uint8_t line = 0;
+    stream_capturing = false;
 
-    for (; start < end; start++)
+    // A line that was cut short still ends like one.
+    if (stream_line_length == STREAM_LINE_SIZE)
     {
-        if (0 == line)
-        {
-            debug_print_pointer(start);
-            DPL(": ");
-        }
-
-        debug_print_u32(*start);
+        stream_line[STREAM_LINE_SIZE - 2] = '\r';
+        stream_line[STREAM_LINE_SIZE - 1] = '\n';
+    }
+}
+#endif // DEBUG_STREAM
 
-        line++;
+static void nway_print_label(const char * label)
+{
+#if DEBUG_STREAM
+    if (stream_capturing_here())
+    {
+        stream_capture(label);
+        return;
+    }
+#endif
 
-        if (16 == line)
+#if OUTPUT_FRAMING
+    frame_append(label);
+#else
+    nway_write(label, (uint32_t) strlen(label));
+#endif
+}
+
+static const char HEX[] = "0123456789ABCDEF";
+
+static void debug_print_u32(uint32_t u32)
+{
+    char output[9] = {0};
+
+    // Always printed as big endian.
+    output[0] = HEX[(((uint32_t) u32 & 0xf0000000) >> 28)];
+    output[1] = HEX[(((uint32_t) u32 & 0x0f000000) >> 24)];
+    output[2] = HEX[(((uint32_t) u32 & 0x00f00000) >> 20)];
+    output[3] = HEX[(((uint32_t) u32 & 0x000f0000) >> 16)];
+    output[4] = HEX[(((uint32_t) u32 & 0x0000f000) >> 12)];
+    output[5] = HEX[(((uint32_t) u32 & 0x00000f00) >>  8)];
+    output[6] = HEX[(((uint32_t) u32 & 0x000000f0) >>  4)];
+    output[7] = HEX[(((uint32_t) u32 & 0x0000000f) >>  0)];
+
+    nway_print_label(output);
+}
+
+static inline void debug_print_pointer(const void * pointer)
+{
+    debug_print_u32((uint32_t) (uintptr_t) pointer);
+}
+
+static inline void debug_print_u16(uint16_t u16)
+{
+    char output[5] = {0};
+
+    output[0] = HEX[(u16 >> 12) & 0xf];
+    output[1] = HEX[(u16 >>  8) & 0xf];
+    output[2] = HEX[(u16 >>  4) & 0xf];
+    output[3] = HEX[(u16 >>  0) & 0xf];
+
+    nway_print_label(output);
+}
+
+// Right-aligned, 0 to 999.
+static inline void debug_print_percent(uint32_t percent)
+{
+    char output[5] = { ' ', ' ', '0', '%', 0 };
+
+    if (percent > 999) percent = 999;
+
+    if (percent > 99) output[0] = (char) ('0' + percent / 100);
+    if (percent > 9)  output[1] = (char) ('0' + (percent / 10) % 10);
+    output[2] = (char) ('0' + percent % 10);
+
+    nway_print_label(output);
+}
+
+#define DPL(X) nway_print_label((X))
+
+// Ends the measurement started by cost_begin() and prints it as a trailer
+// line. The trailer itself is not included in the numbers.
+static void cost_end(void)
+{
+#if DEBUG_SELF_COST
+    if (--cost_depth) return;
+
+    cost_current.total_ticks = cost_now() - cost_start;
+    cost_last = cost_current;
+
+    DPL("     cost ( total: ");
+    debug_print_u32(cost_last.total_ticks);
+
+    DPL(" locked: ");
+    debug_print_u32(cost_last.kernel_locked_ticks);
+
+    DPL(" serial: ");
+    debug_print_u32(cost_last.serial_ticks);
+
+    DPL(" rtt: ");
+    debug_print_u32(cost_last.rtt_ticks);
+
+    DPL(" swo: ");
+    debug_print_u32(cost_last.swo_ticks);
+
+    DPL(" ) bytes ( serial: ");
+    debug_print_u32(cost_last.serial_bytes);
+
+    DPL(" rtt: ");
+    debug_print_u32(cost_last.rtt_bytes);
+
+    DPL(" swo: ");
+    debug_print_u32(cost_last.swo_bytes);
+
+    DPL(" ) ticks/s: ");
+    debug_print_u32(cost_last.ticks_per_second);
+
+    DPL("\r\n");
+#endif
+}
+
+#if DEBUG_SELF_COST
+void get_memory_status_cost(memory_status_cost_t * cost)
+{
+    *cost = cost_last;
+}
+#endif
+
+#if MEMORY_STATUS_RTOS != MEMORY_STATUS_RTOS_NONE
+
+#if MEMORY_STATUS_RTOS == MEMORY_STATUS_RTOS_RTX4
+
+// No public forward declarations for these.
+extern "C" P_TCB rt_tid2ptcb (osThreadId thread_id);
+extern "C" const uint32_t os_stackinfo;
+
+// Refs: rt_CMSIS.c - svcThreadGetInfo()
+//
+// Each _osThreadGetInfo() call is an SVC, so the fields are read straight
+// from the TCB instead, the same way svcThreadGetInfo() computes them.
+// Only OS threads with a default-sized stack (priv_stack == 0), or builds
+// without stack initialization, fall back to the SVC.
+
+static const uint32_t RTX_STACK_MAGIC_PATTERN = 0xCCCCCCCC;
+static const uint32_t RTX_STACK_INIT          = (1U << 28); // os_stackinfo: OS_STKINIT
+
+static void snapshot_thread(osThreadId threadId, memory_status_thread_t * thread)
+{
+    P_TCB tcb = rt_tid2ptcb(threadId);
+
+    thread->stack_start = (uint32_t) (uintptr_t) tcb->stack;
+
+    if (tcb->priv_stack && (os_stackinfo & RTX_STACK_INIT))
+    {
+        const uint32_t * stack = tcb->stack;
+        uint32_t         words = tcb->priv_stack / 4;
+        uint32_t         i;
+
+        // stack[0] holds the overflow check word, not the fill pattern.
+        for (i = 1; i < words; i++)
         {
-            DPL("\r\n");
-            line = 0;
+            if (stack[i] != RTX_STACK_MAGIC_PATTERN) break;
         }
+
+        thread->stack_size = tcb->priv_stack;
+        thread->stack_used = tcb->priv_stack - i * 4;
+    }
+    else
+    {
+        thread->stack_size = _osThreadGetInfo(threadId, osThreadInfoStackSize).value.v;
+        thread->stack_used = _osThreadGetInfo(threadId, osThreadInfoStackMax).value.v;
     }
-}
-#endif
 
-extern uint32_t mbed_stack_isr_size;
+    thread->stack_end   = thread->stack_start + thread->stack_size;
 
-#if DEBUG_ISR_STACK_USAGE
-uint32_t calculate_isr_stack_usage(void)
+    thread->id          = (uint32_t) (uintptr_t) threadId;
+    thread->entry       = (uint32_t) (uintptr_t) tcb->ptask;
+    thread->name        = NULL; // No thread names in CMSIS-RTOS 1.
+    thread->state       = tcb->state;
+    thread->priority    = tcb->prio;
+}
+
+struct rtx4_traits
 {
-    for (const uint32_t * stack = &__StackLimit; stack < &__StackTop; stack++)
+    enum { THREAD_NAMES = 0 };
+
+    static uint32_t snapshot_threads(memory_status_thread_t * threads, uint32_t maxThreads, uint32_t * threadTotal)
     {
-        if (*stack != ISR_STACK_CANARY)
+        osThreadEnumId enumId   = _osThreadsEnumStart();
+        osThreadId     threadId = (osThreadId) NULL; // Can't use nullptr yet because mbed doesn't support C++11.
+        uint32_t       count    = 0;
+        uint32_t       total    = 0;
+
+        while ((threadId = _osThreadEnumNext(enumId)))
         {
-            return (uint32_t) &__StackTop - (uint32_t) stack;
+            if (count < maxThreads)
+            {
+                snapshot_thread(threadId, &threads[count++]);
+            }
+
+            total++;
         }
+
+        _osThreadEnumFree(enumId);
+
+        *threadTotal = total;
+        return count;
     }
+};
 
-    return mbed_stack_isr_size;
+typedef rtx4_traits rtos_traits;
+
+#else
+
+static void snapshot_thread(osThreadId threadId, memory_status_thread_t * thread)
+{
+    // Refs: rtx_lib.h - #define os_thread_t osRtxThread_t
+    //       rtx_os.h  - typedef struct osRtxThread_s { } osRtxThread_t
+
+    os_thread_t * tcb = (os_thread_t *) threadId;
+
+    uint32_t stackSize = osThreadGetStackSize(threadId);
+    uint32_t stackFree = osThreadGetStackSpace(threadId);
+
+    thread->stack_start = (uint32_t) (uintptr_t) tcb->stack_mem;
+    thread->stack_end   = (uint32_t) (uintptr_t) tcb->stack_mem + stackSize;
+    thread->stack_size  = stackSize;
+    thread->stack_used  = stackSize - stackFree;
+
+    thread->id          = (uint32_t) (uintptr_t) threadId;
+    thread->entry       = tcb->thread_addr;
+    thread->name        = osThreadGetName(threadId);
+    thread->state       = (int32_t) osThreadGetState(threadId);
+    thread->priority    = (int32_t) osThreadGetPriority(threadId);
 }
+
+#if DEBUG_SCHED_LATENCY
+// Odd while a report holds the kernel lock. Lets the latency histograms
+// tell which waits a report was responsible for.
+static volatile uint32_t report_lock_count = 0;
 #endif
 
-void print_heap_and_isr_stack_info(void)
+// Every kernel lock a report takes, so that all of them show up in the
+// self cost and in the latency histograms' report count.
+static void report_lock(void)
 {
-    extern unsigned char * mbed_heap_start;
-    extern uint32_t        mbed_heap_size;
+    osKernelLock();
+    cost_lock_begin();
 
-    extern unsigned char * mbed_stack_isr_start;
+#if DEBUG_SCHED_LATENCY
+    report_lock_count++;
+#endif
+}
 
-    mbed_stats_heap_t      heap_stats;
+static void report_unlock(void)
+{
+#if DEBUG_SCHED_LATENCY
+    report_lock_count++;
+#endif
 
-    mbed_stats_heap_get(&heap_stats);
+    cost_lock_end();
+    osKernelUnlock();
+}
 
-    DPL("     heap ( start: ");
-    debug_print_pointer(mbed_heap_start);
+// Static rather than on the caller's stack, so that the stack cost of a
+// report does not grow with the number of threads. Only touched with the
+// kernel locked, so concurrent callers cannot trample on it.
+static osThreadId_t snapshot_thread_ids[MEMORY_STATUS_MAX_THREADS];
 
-    DPL(" end: ");
-    debug_print_pointer(mbed_heap_start + mbed_heap_size);
+struct rtx5_traits
+{
+    enum { THREAD_NAMES = 1 };
 
-    DPL(" size: ");
-    debug_print_u32(mbed_heap_size);
+    static uint32_t snapshot_threads(memory_status_thread_t * threads, uint32_t maxThreads, uint32_t * threadTotal)
+    {
+        // Refs: mbed_stats.c - mbed_stats_stack_get_each()
 
-    DPL(" used: ");
-    debug_print_u32(heap_stats.max_size);
+        report_lock();
 
-    DPL(" )  alloc ( ok: ");
-    debug_print_u32(heap_stats.alloc_cnt);
+        uint32_t threadCount = osThreadGetCount();
+        uint32_t count       = osThreadEnumerate(snapshot_thread_ids, MEMORY_STATUS_MAX_THREADS);
 
-    DPL("  fail: ");
-    debug_print_u32(heap_stats.alloc_fail_cnt);
+        if (count > maxThreads) count = maxThreads;
 
-    DPL(" )\r\n");
+        for (uint32_t i = 0; i < count; i++)
+        {
+            snapshot_thread(snapshot_thread_ids[i], &threads[i]);
+        }
 
-    DPL("isr_stack ( start: ");
-    debug_print_pointer(mbed_stack_isr_start);
+        report_unlock();
+
+        *threadTotal = threadCount;
+        return count;
+    }
+};
+
+typedef rtx5_traits rtos_traits;
+
+#endif
+
+// Everything but the line end, so print_all_thread_info() can append to it.
+template <class Rtos>
+static void print_thread_fields(const memory_status_thread_t * thread)
+{
+    DPL("    stack ( start: ");
+    debug_print_u32(thread->stack_start);
 
     DPL(" end: ");
-    debug_print_pointer(mbed_stack_isr_start + mbed_stack_isr_size);
+    debug_print_u32(thread->stack_end);
 
     DPL(" size: ");
-    debug_print_u32(mbed_stack_isr_size);
+    debug_print_u32(thread->stack_size);
 
-#if DEBUG_ISR_STACK_USAGE
     DPL(" used: ");
-    debug_print_u32(calculate_isr_stack_usage());
+    debug_print_u32(thread->stack_used);
+
+    DPL(" ) ");
+
+    DPL("thread ( id: ");
+    debug_print_u32(thread->id);
+
+    DPL(" entry: ");
+    debug_print_u32(thread->entry);
+
+    if (Rtos::THREAD_NAMES)
+    {
+        DPL(" name: ");
+        DPL(thread->name ? thread->name : "unknown");
+    }
+
+    DPL(" )");
+}
+
+#if DEBUG_STREAM || DEBUG_FLIGHT_RECORDER
+static void print_thread_info(const memory_status_thread_t * thread)
+{
+    print_thread_fields<rtos_traits>(thread);
+    DPL("\r\n");
+}
 #endif
 
-    DPL(" )\r\n");
+#if DEBUG_THREAD_CPU_TIME || DEBUG_SCHED_LATENCY
+// Thread switch accounting
+//
+// memory_status_thread_switched() is called on every context switch with
+// the thread about to run, memory_status_thread_ready() whenever a blocked
+// thread is made ready. Both look the thread up in a small open-addressed
+// table keyed by thread id. In the common case that is one read of
+// DWT->CYCCNT, a few adds and one probe.
+//
+// DEBUG_THREAD_CPU_TIME charges the cycles since the previous switch to
+// the thread that was running. Each report prints every thread's share of
+// the CPU since the last report.
+//
+// DEBUG_SCHED_LATENCY records the cycles from ready to running in a log2
+// histogram per thread, kept since boot. Waits during which a report held
+// the kernel lock are counted separately, so it shows directly whether the
+// report delays other threads.
 
-#if DEBUG_MEMORY_CONTENTS
-    // Print ISR stack contents.
-    print_memory_contents(&__StackLimit, &__StackTop);
+#if MEMORY_STATUS_RTOS != MEMORY_STATUS_RTOS_RTX5
+#error "DEBUG_THREAD_CPU_TIME and DEBUG_SCHED_LATENCY need CMSIS-RTOS 2 (mbed OS 5.5 and up)."
+#endif
+
+#if !defined (DWT_CTRL_CYCCNTENA_Msk)
+#error "DEBUG_THREAD_CPU_TIME and DEBUG_SCHED_LATENCY need the DWT cycle counter (Cortex-M3 and up)."
+#endif
+
+#if !MEMORY_STATUS_THREAD_EVENTS
+#error "DEBUG_THREAD_CPU_TIME and DEBUG_SCHED_LATENCY need RTX5's thread events: set OS_EVR_THREAD and do not define EVR_RTX_DISABLE."
+#endif
+
+#ifndef THREAD_SLOTS
+#define THREAD_SLOTS  32 // Power of two, comfortably above the thread count.
+#endif
+
+#ifndef SCHED_LATENCY_BUCKETS
+#define SCHED_LATENCY_BUCKETS  16
+#endif
+
+#ifndef SCHED_LATENCY_SHIFT
+#define SCHED_LATENCY_SHIFT     6 // Bucket 0 is everything below 64 cycles.
+#endif
+
+typedef struct
+{
+    const void * thread;
+    uint32_t     generation;    // thread_slots_generation when last seen alive.
+#if DEBUG_THREAD_CPU_TIME
+    uint32_t     cycles;        // Total since boot, wraps.
+    uint32_t     reported;      // cycles at the last report.
+#endif
+#if DEBUG_SCHED_LATENCY
+    bool         waiting;       // Ready, but not switched to yet.
+    uint32_t     ready_at;      // CYCCNT when made ready.
+    uint32_t     ready_locks;   // report_lock_count when made ready.
+    uint32_t     latency_max;
+    uint16_t     latency_report;
+    uint16_t     latency[SCHED_LATENCY_BUCKETS];
+#endif
+} thread_slot_t;
+
+static thread_slot_t   thread_slots[THREAD_SLOTS];
+static thread_slot_t   thread_untracked;    // Before the first switch, or table full.
+static thread_slot_t * thread_running = &thread_untracked;
+static bool            thread_slots_started = false;
+static uint32_t        thread_slots_generation = 0;
+
+#if DEBUG_THREAD_CPU_TIME
+static uint32_t        cpu_time_last_switch = 0;
+static uint32_t        cpu_time_last_report = 0;
+#endif
+
+static void thread_slots_start(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+#if DEBUG_THREAD_CPU_TIME
+    cpu_time_last_switch = DWT->CYCCNT;
+    cpu_time_last_report = cpu_time_last_switch;
 #endif
+
+    thread_slots_started = true;
+}
+
+static uint32_t thread_slot_home(const void * thread)
+{
+    return ((uint32_t) (uintptr_t) thread >> 3) & (THREAD_SLOTS - 1);
+}
+
+// Only the RTOS hooks claim slots. They all run from the SVC / PendSV
+// handlers and so never preempt each other, and a report racing with them
+// never sees a half-claimed slot. Slots are only released by
+// thread_slots_sweep(), with interrupts masked.
+static thread_slot_t * thread_slot(const void * thread, bool claim)
+{
+    uint32_t index = thread_slot_home(thread);
+
+    for (uint32_t probes = THREAD_SLOTS; probes; probes--)
+    {
+        thread_slot_t * slot = &thread_slots[index];
+
+        if (slot->thread == thread)
+        {
+            if (claim) slot->generation = thread_slots_generation;
+
+            return slot;
+        }
+
+        if (!slot->thread)
+        {
+            if (!claim) break;
+
+            slot->thread     = thread;
+            slot->generation = thread_slots_generation;
+            return slot;
+        }
+
+        index = (index + 1) & (THREAD_SLOTS - 1);
+    }
+
+    return &thread_untracked;
+}
+
+// Linear probing without tombstones: every later slot in the same run that
+// may live at or before the hole is moved back into it, so lookups still
+// find it, and the last hole is cleared.
+static void thread_slot_release(thread_slot_t * slot)
+{
+    uint32_t hole = (uint32_t) (slot - thread_slots);
+    uint32_t next = hole;
+
+    for (uint32_t probes = THREAD_SLOTS - 1; probes; probes--)
+    {
+        next = (next + 1) & (THREAD_SLOTS - 1);
+
+        if (!thread_slots[next].thread) break;
+
+        uint32_t home = thread_slot_home(thread_slots[next].thread);
+
+        if (((next - home) & (THREAD_SLOTS - 1)) >= ((next - hole) & (THREAD_SLOTS - 1)))
+        {
+            thread_slots[hole] = thread_slots[next];
+
+            if (thread_running == &thread_slots[next]) thread_running = &thread_slots[hole];
+
+            hole = next;
+        }
+    }
+
+    memset(&thread_slots[hole], 0, sizeof(thread_slots[hole]));
+}
+
+// After each report: threads in it, and threads switched to since the last
+// sweep, are alive. Every other slot belongs to a thread that has exited
+// and is released, so the table does not fill up with dead threads.
+static void thread_slots_sweep(const memory_status_thread_t * threads, uint32_t count)
+{
+    core_util_critical_section_enter();
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        thread_slot_t * slot = thread_slot((const void *) (uintptr_t) threads[i].id, false);
+
+        if (slot != &thread_untracked) slot->generation = thread_slots_generation;
+    }
+
+    for (uint32_t index = 0; index < THREAD_SLOTS; )
+    {
+        thread_slot_t * slot = &thread_slots[index];
+
+        // Released slots are filled from further along, so look again.
+        if (slot->thread && slot->generation != thread_slots_generation)
+        {
+            thread_slot_release(slot);
+        }
+        else
+        {
+            index++;
+        }
+    }
+
+    thread_slots_generation++;
+
+    core_util_critical_section_exit();
+}
+
+#if DEBUG_SCHED_LATENCY
+static void sched_latency_record(thread_slot_t * slot, uint32_t now)
+{
+    uint32_t latency = now - slot->ready_at;
+    uint32_t scaled  = latency >> SCHED_LATENCY_SHIFT;
+    uint32_t bucket  = scaled ? 32 - __CLZ(scaled) : 0;
+
+    if (bucket >= SCHED_LATENCY_BUCKETS) bucket = SCHED_LATENCY_BUCKETS - 1;
+
+    if (slot->latency[bucket] != 0xFFFF) slot->latency[bucket]++;
+
+    if (latency > slot->latency_max) slot->latency_max = latency;
+
+    // Odd means a report held the kernel lock when the thread was made
+    // ready, a change means one took it before the thread got to run.
+    bool report = (slot->ready_locks & 1) || slot->ready_locks != report_lock_count;
+
+    if (report && slot->latency_report != 0xFFFF) slot->latency_report++;
+
+    slot->waiting = false;
+}
+
+void memory_status_thread_ready(void * thread)
+{
+    if (!thread_slots_started) thread_slots_start();
+
+    thread_slot_t * slot = thread_slot(thread, true);
+
+    if (slot == &thread_untracked) return;
+
+    slot->waiting     = true;
+    slot->ready_at    = DWT->CYCCNT;
+    slot->ready_locks = report_lock_count;
+}
+
+// Called by RTX5 whenever a blocked thread is made ready, with the same
+// preconditions as EvrRtxThreadSwitched() below.
+extern "C" void EvrRtxThreadUnblocked(osThreadId_t thread_id, uint32_t ret_val)
+{
+    (void) ret_val;
+
+    memory_status_thread_ready(thread_id);
+}
+#endif
+
+void memory_status_thread_switched(void * thread)
+{
+    if (!thread_slots_started) thread_slots_start();
+
+    uint32_t now = DWT->CYCCNT;
+
+#if DEBUG_THREAD_CPU_TIME
+    thread_running->cycles += now - cpu_time_last_switch;
+    cpu_time_last_switch    = now;
+#endif
+
+    thread_running = thread_slot(thread, true);
+
+#if DEBUG_SCHED_LATENCY
+    if (thread_running->waiting) sched_latency_record(thread_running, now);
+#endif
+
+    (void) now;
+}
+
+// RTX5 calls this on every switch when its thread events are enabled
+// (MEMORY_STATUS_THREAD_EVENTS, checked above). The default in rtx_evr.c
+// is weak, so this one replaces it.
+extern "C" void EvrRtxThreadSwitched(osThreadId_t thread_id)
+{
+    memory_status_thread_switched(thread_id);
+}
+
+// The next thread created may get the same control block, so the slot is
+// cleared for it now rather than handed over. If none is, the next sweep
+// releases the slot.
+static void thread_slot_destroyed(void * thread)
+{
+    thread_slot_t * slot = thread_slot(thread, false);
+
+    if (slot == &thread_untracked) return;
+
+    uint32_t generation = slot->generation;
+
+    memset(slot, 0, sizeof(*slot));
+
+    slot->thread     = thread;
+    slot->generation = generation;
+}
+
+#if DEBUG_THREAD_CPU_TIME
+// Percentage of the cycles since the last report that thread ran for.
+static void print_thread_cpu_load(const memory_status_thread_t * thread, uint32_t window)
+{
+    thread_slot_t * slot = thread_slot((const void *) (uintptr_t) thread->id, false);
+    uint32_t        load = 0;
+
+    // A thread without a slot has not been switched to since counting began.
+    if (slot != &thread_untracked)
+    {
+        uint32_t cycles = slot->cycles;
+        uint32_t delta  = cycles - slot->reported;
+
+        if (window) load = (uint32_t) (((uint64_t) delta * 100) / window);
+
+        slot->reported = cycles;
+    }
+
+    DPL(" cpu ( load: ");
+    debug_print_percent(load);
+    DPL(" )");
+}
+#endif
+
+#if DEBUG_SCHED_LATENCY
+// Printed on its own line below the thread, once the thread has been made
+// ready at least once. Trailing empty buckets are left out.
+static void print_thread_sched_latency(const memory_status_thread_t * thread)
+{
+    const thread_slot_t * slot = thread_slot((const void *) (uintptr_t) thread->id, false);
+
+    if (slot == &thread_untracked) return;
+
+    uint32_t buckets = SCHED_LATENCY_BUCKETS;
+
+    while (buckets && 0 == slot->latency[buckets - 1]) buckets--;
+
+    if (0 == buckets) return;
+
+    DPL("      latency ( max: ");
+    debug_print_u32(slot->latency_max);
+
+    DPL(" report: ");
+    debug_print_u16(slot->latency_report);
+
+    DPL(" log2:");
+
+    for (uint32_t i = 0; i < buckets; i++)
+    {
+        DPL(" ");
+        debug_print_u16(slot->latency[i]);
+    }
+
+    DPL(" )\r\n");
+}
+#endif
+#endif // DEBUG_THREAD_CPU_TIME || DEBUG_SCHED_LATENCY
+
+#if DEBUG_CONTENTION
+// Mutex and semaphore contention
+//
+// RTX5 has no event that says which thread a released object was handed
+// to, so instead of event hooks this wraps osMutexAcquire() and
+// osSemaphoreAcquire() at link time (-Wl,--wrap=osMutexAcquire
+// -Wl,--wrap=osSemaphoreAcquire). That catches every caller, including
+// the mutex mbed's malloc and stdio retarget code take internally.
+//
+// Each acquisition is first tried without waiting. Only if that fails is
+// the clock started and the caller's timeout used, so uncontended
+// acquisitions cost one extra table lookup and nothing else. A wait that
+// times out is counted like any other, and as a timeout.
+//
+// osMutexDelete() and osSemaphoreDelete() are wrapped too
+// (-Wl,--wrap=osMutexDelete -Wl,--wrap=osSemaphoreDelete): the next object
+// created may get the same control block, and must not inherit the slot.
+
+#if MEMORY_STATUS_RTOS != MEMORY_STATUS_RTOS_RTX5
+#error "DEBUG_CONTENTION needs CMSIS-RTOS 2 (mbed OS 5.5 and up)."
+#endif
+
+#if !defined (DWT_CTRL_CYCCNTENA_Msk)
+#error "DEBUG_CONTENTION needs the DWT cycle counter (Cortex-M3 and up)."
+#endif
+
+#ifndef CONTENTION_SLOTS
+#define CONTENTION_SLOTS  32 // Power of two, comfortably above the object count.
+#endif
+
+#ifndef CONTENTION_TOP
+#define CONTENTION_TOP     8 // Objects printed per report, most waited on first.
+#endif
+
+enum
+{
+    CONTENTION_MUTEX     = 1,
+    CONTENTION_SEMAPHORE = 2
+};
+
+typedef struct
+{
+    const void * object;
+    uint32_t     kind;
+    uint32_t     acquired;
+    uint32_t     contended;     // Had to wait, acquired or not.
+    uint32_t     timeouts;      // Waited, and gave up.
+    uint32_t     wait_total;    // Cycles, wraps.
+    uint32_t     wait_max;
+} contention_slot_t;
+
+static contention_slot_t contention_slots[CONTENTION_SLOTS];
+static contention_slot_t contention_untracked; // Table full.
+static bool              contention_started = false;
+
+extern "C" osStatus_t __real_osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout);
+extern "C" osStatus_t __real_osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout);
+extern "C" osStatus_t __real_osMutexDelete(osMutexId_t mutex_id);
+extern "C" osStatus_t __real_osSemaphoreDelete(osSemaphoreId_t semaphore_id);
+
+static uint32_t contention_now(void)
+{
+    if (!contention_started)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+        contention_started = true;
+    }
+
+    return DWT->CYCCNT;
+}
+
+static uint32_t contention_home(const void * object)
+{
+    return ((uint32_t) (uintptr_t) object >> 3) & (CONTENTION_SLOTS - 1);
+}
+
+// Must be called inside a critical section.
+static contention_slot_t * contention_slot(const void * object, uint32_t kind, bool claim)
+{
+    uint32_t index = contention_home(object);
+
+    for (uint32_t probes = CONTENTION_SLOTS; probes; probes--)
+    {
+        contention_slot_t * slot = &contention_slots[index];
+
+        if (slot->object == object) return slot;
+
+        if (!slot->object)
+        {
+            if (!claim) break;
+
+            slot->object = object;
+            slot->kind   = kind;
+            return slot;
+        }
+
+        index = (index + 1) & (CONTENTION_SLOTS - 1);
+    }
+
+    return &contention_untracked;
+}
+
+// Must be called inside a critical section. Same backward shift as
+// thread_slot_release().
+static void contention_slot_release(contention_slot_t * slot)
+{
+    uint32_t hole = (uint32_t) (slot - contention_slots);
+    uint32_t next = hole;
+
+    for (uint32_t probes = CONTENTION_SLOTS - 1; probes; probes--)
+    {
+        next = (next + 1) & (CONTENTION_SLOTS - 1);
+
+        if (!contention_slots[next].object) break;
+
+        uint32_t home = contention_home(contention_slots[next].object);
+
+        if (((next - home) & (CONTENTION_SLOTS - 1)) >= ((next - hole) & (CONTENTION_SLOTS - 1)))
+        {
+            contention_slots[hole] = contention_slots[next];
+            hole = next;
+        }
+    }
+
+    memset(&contention_slots[hole], 0, sizeof(contention_slots[hole]));
+}
+
+static void contention_record(const void * object, uint32_t kind, osStatus_t status, bool contended, uint32_t wait)
+{
+    core_util_critical_section_enter();
+
+    contention_slot_t * slot = contention_slot(object, kind, true);
+
+    if (osOK == status) slot->acquired++;
+    else                slot->timeouts++;
+
+    if (contended)
+    {
+        slot->contended++;
+        slot->wait_total += wait;
+
+        if (wait > slot->wait_max) slot->wait_max = wait;
+    }
+
+    core_util_critical_section_exit();
+}
+
+static void contention_forget(const void * object)
+{
+    core_util_critical_section_enter();
+
+    contention_slot_t * slot = contention_slot(object, 0, false);
+
+    if (slot != &contention_untracked) contention_slot_release(slot);
+
+    core_util_critical_section_exit();
+}
+
+// RTX5 gives up on a wait with osErrorTimeout, or with osErrorResource
+// when the object is deleted meanwhile; either way the wait happened.
+static bool contention_waited(osStatus_t status)
+{
+    return osOK == status || osErrorTimeout == status || osErrorResource == status;
+}
+
+extern "C" osStatus_t __wrap_osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    osStatus_t status = __real_osMutexAcquire(mutex_id, 0);
+
+    if (osOK == status)
+    {
+        contention_record(mutex_id, CONTENTION_MUTEX, status, false, 0);
+    }
+    else if (osErrorResource == status && timeout)
+    {
+        uint32_t start = contention_now();
+
+        status = __real_osMutexAcquire(mutex_id, timeout);
+
+        if (contention_waited(status)) contention_record(mutex_id, CONTENTION_MUTEX, status, true, contention_now() - start);
+    }
+
+    return status;
+}
+
+extern "C" osStatus_t __wrap_osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+    osStatus_t status = __real_osSemaphoreAcquire(semaphore_id, 0);
+
+    if (osOK == status)
+    {
+        contention_record(semaphore_id, CONTENTION_SEMAPHORE, status, false, 0);
+    }
+    else if (osErrorResource == status && timeout)
+    {
+        uint32_t start = contention_now();
+
+        status = __real_osSemaphoreAcquire(semaphore_id, timeout);
+
+        if (contention_waited(status)) contention_record(semaphore_id, CONTENTION_SEMAPHORE, status, true, contention_now() - start);
+    }
+
+    return status;
+}
+
+extern "C" osStatus_t __wrap_osMutexDelete(osMutexId_t mutex_id)
+{
+    osStatus_t status = __real_osMutexDelete(mutex_id);
+
+    if (osOK == status) contention_forget(mutex_id);
+
+    return status;
+}
+
+extern "C" osStatus_t __wrap_osSemaphoreDelete(osSemaphoreId_t semaphore_id)
+{
+    osStatus_t status = __real_osSemaphoreDelete(semaphore_id);
+
+    if (osOK == status) contention_forget(semaphore_id);
+
+    return status;
+}
+
+// Copied out under the critical section, then sorted and printed from the
+// copy, the same way the thread lines are.
+static contention_slot_t report_contention[CONTENTION_SLOTS];
+
+static void print_contention_info(void)
+{
+    core_util_critical_section_enter();
+    memcpy(report_contention, contention_slots, sizeof(report_contention));
+    core_util_critical_section_exit();
+
+    // Insertion sort by total wait, descending. Small enough not to matter.
+    for (uint32_t i = 1; i < CONTENTION_SLOTS; i++)
+    {
+        contention_slot_t slot = report_contention[i];
+        uint32_t          j    = i;
+
+        for (; j && report_contention[j - 1].wait_total < slot.wait_total; j--)
+        {
+            report_contention[j] = report_contention[j - 1];
+        }
+
+        report_contention[j] = slot;
+    }
+
+    for (uint32_t i = 0; i < CONTENTION_TOP && i < CONTENTION_SLOTS; i++)
+    {
+        const contention_slot_t * slot = &report_contention[i];
+
+        if (!slot->object || !slot->contended) break;
+
+        const char * name;
+
+        if (CONTENTION_MUTEX == slot->kind)
+        {
+            DPL("    mutex ( id: ");
+            name = osMutexGetName((osMutexId_t) slot->object);
+        }
+        else
+        {
+            DPL("    semaphore ( id: ");
+            name = osSemaphoreGetName((osSemaphoreId_t) slot->object);
+        }
+
+        debug_print_pointer(slot->object);
+
+        DPL(" name: ");
+        DPL(name ? name : "unknown");
+
+        DPL(" ) contention ( acquired: ");
+        debug_print_u32(slot->acquired);
+
+        DPL(" contended: ");
+        debug_print_u32(slot->contended);
+
+        DPL(" timeouts: ");
+        debug_print_u32(slot->timeouts);
+
+        DPL(" wait: ");
+        debug_print_u32(slot->wait_total);
+
+        DPL(" max: ");
+        debug_print_u32(slot->wait_max);
+
+        DPL(" )\r\n");
+    }
+
+    if (contention_untracked.acquired || contention_untracked.timeouts)
+    {
+        DPL("    (objects not tracked, raise CONTENTION_SLOTS)\r\n");
+    }
+}
+#endif // DEBUG_CONTENTION
+
+#if DEBUG_PC_SAMPLER
+// PC sampling profiler
+//
+// A Ticker interrupt reads the PC from the exception frame the hardware
+// stacked on the process stack of the thread it interrupted, and counts
+// it against that thread in an open-addressed table keyed by (thread, PC
+// block). Nearby PCs share a block, so the table holds functions and hot
+// loops rather than single instructions. Probing is bounded; samples that
+// find no slot are counted as dropped instead of slowing the interrupt.
+//
+// Samples taken while another interrupt was running are charged to the
+// thread that interrupt preempted.
+
+#if MEMORY_STATUS_RTOS != MEMORY_STATUS_RTOS_RTX5
+#error "DEBUG_PC_SAMPLER needs CMSIS-RTOS 2 (mbed OS 5.5 and up)."
+#endif
+
+#ifndef PC_SAMPLER_SLOTS
+#define PC_SAMPLER_SLOTS   128 // Power of two, 12 bytes each.
+#endif
+
+#ifndef PC_SAMPLER_SHIFT
+#define PC_SAMPLER_SHIFT     4 // PCs within 16 bytes share a slot.
+#endif
+
+#ifndef PC_SAMPLER_PROBES
+#define PC_SAMPLER_PROBES    8 // Upper bound on the work per sample.
+#endif
+
+static memory_status_pc_sample_t pc_sampler_slots[PC_SAMPLER_SLOTS];
+static uint32_t                  pc_sampler_dropped = 0;
+static uint32_t                  pc_sampler_hz      = 0;
+static uint32_t                  pc_sampler_cursor  = 0;  // Next record to read, 0 is the header.
+static Ticker                    pc_sampler_ticker;
+
+static void pc_sampler_tick(void)
+{
+    uint32_t thread = (uint32_t) (uintptr_t) osRtxInfo.thread.run.curr;
+
+    if (!thread) return;
+
+    // R0, R1, R2, R3, R12, LR, PC, xPSR. An FPU frame adds to the end.
+    const uint32_t * frame = (const uint32_t *) (uintptr_t) __get_PSP();
+    uint32_t         pc    = frame[6] & ~((1UL << PC_SAMPLER_SHIFT) - 1);
+    uint32_t         index = ((((pc >> PC_SAMPLER_SHIFT) ^ (thread >> 3)) * 2654435761UL) >> 16) & (PC_SAMPLER_SLOTS - 1);
+
+    for (uint32_t probes = PC_SAMPLER_PROBES; probes; probes--)
+    {
+        memory_status_pc_sample_t * slot = &pc_sampler_slots[index];
+
+        if (slot->pc == pc && slot->thread == thread)
+        {
+            slot->count++;
+            return;
+        }
+
+        if (!slot->count)
+        {
+            slot->thread = thread;
+            slot->pc     = pc;
+            slot->count  = 1;
+            return;
+        }
+
+        index = (index + 1) & (PC_SAMPLER_SLOTS - 1);
+    }
+
+    pc_sampler_dropped++;
+}
+
+void memory_status_sampler_start(uint32_t hz)
+{
+    if (hz < 10)    hz = 10;
+    if (hz > 10000) hz = 10000;
+
+    pc_sampler_ticker.detach();
+
+    memset(pc_sampler_slots, 0, sizeof(pc_sampler_slots));
+    pc_sampler_dropped = 0;
+    pc_sampler_hz      = hz;
+    pc_sampler_cursor  = 0;
+
+    pc_sampler_ticker.attach_us(pc_sampler_tick, 1000000 / hz);
+}
+
+void memory_status_sampler_stop(void)
+{
+    pc_sampler_ticker.detach();
+
+    pc_sampler_cursor = 0;
+}
+
+// buffer is usually a packet buffer with no particular alignment, so the
+// records are copied in bytewise rather than stored as structs.
+uint32_t memory_status_sampler_read(void * buffer, uint32_t size)
+{
+    uint8_t * out    = (uint8_t *) buffer;
+    uint32_t  copied = 0;
+
+    while (size - copied >= sizeof(memory_status_pc_sample_t) && pc_sampler_cursor <= PC_SAMPLER_SLOTS)
+    {
+        if (0 == pc_sampler_cursor)
+        {
+            memory_status_pc_sample_t header;
+
+            header.thread = 0;
+            header.pc     = pc_sampler_hz;
+            header.count  = pc_sampler_dropped;
+
+            memcpy(out + copied, &header, sizeof(header));
+            copied += sizeof(header);
+        }
+        else if (pc_sampler_slots[pc_sampler_cursor - 1].count)
+        {
+            memcpy(out + copied, &pc_sampler_slots[pc_sampler_cursor - 1], sizeof(memory_status_pc_sample_t));
+            copied += sizeof(memory_status_pc_sample_t);
+        }
+
+        pc_sampler_cursor++;
+    }
+
+    return copied;
+}
+#endif // DEBUG_PC_SAMPLER
+
+#if DEBUG_QUANTILES
+// Streaming quantiles
+//
+// The extended P² algorithm (Jain & Chlamtac, extended to several
+// quantiles by Raatikainen) keeps nine markers whose heights converge on
+// the minimum, p50, p90, p99, the maximum and the points half-way
+// between them. Each new sample moves at most every marker by one
+// position, so the cost per sample is constant and the sketch stays at
+// 76 bytes no matter how long the device runs.
+//
+// Fed from memory_status_stack_sample(): one sketch per thread for stack
+// depth, one for the heap's current_size.
+
+#if !DEBUG_STACK_SAMPLER
+#error "DEBUG_QUANTILES is fed by the stack sampler; also set DEBUG_STACK_SAMPLER=1."
+#endif
+
+enum
+{
+    QUANTILE_MARKERS = 9,
+    QUANTILE_P50     = 2,
+    QUANTILE_P90     = 4,
+    QUANTILE_P99     = 6,
+    QUANTILE_MAX     = 8
+};
+
+// Marker targets in 1/1000, with the in-between markers P² needs.
+static const uint16_t QUANTILE_PERMILLE[QUANTILE_MARKERS] = { 0, 250, 500, 700, 900, 945, 990, 995, 1000 };
+
+typedef struct
+{
+    uint32_t count;
+    int32_t  position[QUANTILE_MARKERS];   // 1-based rank of each marker.
+    float    height[QUANTILE_MARKERS];
+} quantile_sketch_t;
+
+static float quantile_parabolic(const quantile_sketch_t * sketch, uint32_t i, int32_t d)
+{
+    const int32_t * n = sketch->position;
+    const float   * h = sketch->height;
+
+    return h[i] + (float) d / (float) (n[i + 1] - n[i - 1]) *
+           ((float) (n[i] - n[i - 1] + d) * (h[i + 1] - h[i]) / (float) (n[i + 1] - n[i]) +
+            (float) (n[i + 1] - n[i] - d) * (h[i] - h[i - 1]) / (float) (n[i] - n[i - 1]));
+}
+
+static void quantile_add(quantile_sketch_t * sketch, uint32_t value)
+{
+    float x = (float) value;
+
+    // The first samples are just kept sorted.
+    if (sketch->count < QUANTILE_MARKERS)
+    {
+        uint32_t i = sketch->count++;
+
+        for (; i && sketch->height[i - 1] > x; i--) sketch->height[i] = sketch->height[i - 1];
+
+        sketch->height[i] = x;
+
+        if (QUANTILE_MARKERS == sketch->count)
+        {
+            for (uint32_t m = 0; m < QUANTILE_MARKERS; m++) sketch->position[m] = (int32_t) m + 1;
+        }
+
+        return;
+    }
+
+    uint32_t k;
+
+    if (x < sketch->height[0])
+    {
+        sketch->height[0] = x;
+        k = 0;
+    }
+    else if (x >= sketch->height[QUANTILE_MARKERS - 1])
+    {
+        sketch->height[QUANTILE_MARKERS - 1] = x;
+        k = QUANTILE_MARKERS - 2;
+    }
+    else
+    {
+        for (k = 0; x >= sketch->height[k + 1]; k++) {}
+    }
+
+    for (uint32_t m = k + 1; m < QUANTILE_MARKERS; m++) sketch->position[m]++;
+
+    sketch->count++;
+
+    // Move the inner markers towards their desired rank, 1 + (count - 1) * q.
+    // Worked in 1/1000 so that it stays exact however large count gets.
+    for (uint32_t i = 1; i < QUANTILE_MARKERS - 1; i++)
+    {
+        int64_t desired = 1000 + (int64_t) (sketch->count - 1) * QUANTILE_PERMILLE[i];
+        int64_t offset  = desired - (int64_t) sketch->position[i] * 1000;
+        int32_t d;
+
+        if      (offset >=  1000 && sketch->position[i + 1] - sketch->position[i] > 1) d =  1;
+        else if (offset <= -1000 && sketch->position[i - 1] - sketch->position[i] < -1) d = -1;
+        else continue;
+
+        float height = quantile_parabolic(sketch, i, d);
+
+        if (!(sketch->height[i - 1] < height && height < sketch->height[i + 1]))
+        {
+            height = sketch->height[i] + (float) d * (sketch->height[i + d] - sketch->height[i]) /
+                                         (float) (sketch->position[i + d] - sketch->position[i]);
+        }
+
+        sketch->height[i]    = height;
+        sketch->position[i] += d;
+    }
+}
+
+static uint32_t quantile_get(const quantile_sketch_t * sketch, uint32_t marker)
+{
+    if (0 == sketch->count) return 0;
+
+    // Until the markers are set up, the sorted samples are exact.
+    if (sketch->count < QUANTILE_MARKERS)
+    {
+        return (uint32_t) sketch->height[((sketch->count - 1) * QUANTILE_PERMILLE[marker] + 500) / 1000];
+    }
+
+    return (uint32_t) (sketch->height[marker] + 0.5f);
+}
+
+static void print_quantile_sketch(const char * label, const quantile_sketch_t * sketch)
+{
+    DPL(label);
+    DPL(" since boot ( p50: ");
+    debug_print_u32(quantile_get(sketch, QUANTILE_P50));
+
+    DPL(" p90: ");
+    debug_print_u32(quantile_get(sketch, QUANTILE_P90));
+
+    DPL(" p99: ");
+    debug_print_u32(quantile_get(sketch, QUANTILE_P99));
+
+    DPL(" max: ");
+    debug_print_u32(quantile_get(sketch, QUANTILE_MAX));
+
+    DPL(" samples: ");
+    debug_print_u32(sketch->count);
+
+    DPL(" )\r\n");
+}
+
+static quantile_sketch_t heap_sketch;
+#endif // DEBUG_QUANTILES
+
+#if DEBUG_STACK_SAMPLER
+// Live stack depth
+//
+// memory_status_stack_sample() reads every thread's current stack depth:
+// the SP saved in the TCB on its last switch out for suspended threads,
+// the real SP for the calling thread. Depth goes into a histogram per
+// thread, in STACK_SAMPLER_BUCKETS fractions of the stack size, so the
+// report can show typical depth next to the all-time high-water mark.
+//
+// When a bucket would overflow, all of that thread's buckets are halved.
+// Old samples fade out instead of the histogram saturating.
+
+#if MEMORY_STATUS_RTOS != MEMORY_STATUS_RTOS_RTX5
+#error "DEBUG_STACK_SAMPLER needs CMSIS-RTOS 2 (mbed OS 5.5 and up)."
+#endif
+
+#ifndef STACK_SAMPLER_BUCKETS
+#define STACK_SAMPLER_BUCKETS  32
+#endif
+
+typedef struct
+{
+    uint32_t thread;
+    uint32_t generation;    // Last sample that saw this thread.
+    uint32_t samples;
+    uint32_t skipped;       // Seen with its SP outside its stack.
+    uint32_t max;           // Bytes.
+    uint16_t depth[STACK_SAMPLER_BUCKETS];
+#if DEBUG_QUANTILES
+    quantile_sketch_t depth_sketch;
+#endif
+} stack_sampler_slot_t;
+
+// One thread as read with the kernel locked; the slot is updated after.
+typedef struct
+{
+    uint32_t thread;
+    uint32_t depth;
+    uint32_t size;          // 0 if the SP was outside the stack.
+} stack_sampler_read_t;
+
+static stack_sampler_slot_t stack_sampler_slots[MEMORY_STATUS_MAX_THREADS];
+static stack_sampler_read_t stack_sampler_reads[MEMORY_STATUS_MAX_THREADS];
+static uint32_t             stack_sampler_generation = 0;
+
+static stack_sampler_slot_t * stack_sampler_slot(uint32_t thread, bool claim)
+{
+    stack_sampler_slot_t * unused = NULL;
+
+    for (uint32_t i = 0; i < MEMORY_STATUS_MAX_THREADS; i++)
+    {
+        if (stack_sampler_slots[i].thread == thread) return &stack_sampler_slots[i];
+
+        if (!unused && !stack_sampler_slots[i].thread) unused = &stack_sampler_slots[i];
+    }
+
+    if (!claim || !unused) return NULL;
+
+    memset(unused, 0, sizeof(*unused));
+    unused->thread = thread;
+
+    return unused;
+}
+
+static void stack_sampler_add(stack_sampler_slot_t * slot, uint32_t depth, uint32_t size)
+{
+    uint32_t bucket = (uint32_t) (((uint64_t) depth * STACK_SAMPLER_BUCKETS) / size);
+
+    if (bucket >= STACK_SAMPLER_BUCKETS) bucket = STACK_SAMPLER_BUCKETS - 1;
+
+    if (0xFFFF == slot->depth[bucket])
+    {
+        for (uint32_t i = 0; i < STACK_SAMPLER_BUCKETS; i++) slot->depth[i] >>= 1;
+    }
+
+    slot->depth[bucket]++;
+    slot->samples++;
+
+    if (depth > slot->max) slot->max = depth;
+}
+
+// Only the kernel lock keeps a report from reading a slot half updated,
+// and the quantile update is float work that has no business under it.
+// So the depths are read with the kernel locked, the sketches updated on
+// copies with it unlocked, and each slot written back under a short lock
+// of its own. Only this function writes the slots, so nothing changes in
+// between as long as it is not called from two threads at once.
+void memory_status_stack_sample(void)
+{
+    // Same reasoning as for snapshot_thread_ids.
+    static osThreadId_t threadIds[MEMORY_STATUS_MAX_THREADS];
+
+    // Close enough to the calling thread's SP, whose TCB copy is stale.
+    uint32_t here = (uint32_t) (uintptr_t) &here;
+
+#if DEBUG_QUANTILES
+    // Takes the malloc mutex, so not with the kernel locked.
+    mbed_stats_heap_t heap_stats;
+
+    mbed_stats_heap_get(&heap_stats);
+
+    quantile_sketch_t sketch = heap_sketch;
+
+    quantile_add(&sketch, heap_stats.current_size);
+
+    osKernelLock();
+    heap_sketch = sketch;
+    osKernelUnlock();
+#endif
+
+    osKernelLock();
+
+    uint32_t     count = osThreadEnumerate(threadIds, MEMORY_STATUS_MAX_THREADS);
+    uint32_t     total = osThreadGetCount();
+    osThreadId_t self  = osThreadGetId();
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const os_thread_t * tcb   = (const os_thread_t *) threadIds[i];
+        uint32_t            start = (uint32_t) (uintptr_t) tcb->stack_mem;
+        uint32_t            end   = start + tcb->stack_size;
+        uint32_t            sp    = (threadIds[i] == self) ? here : tcb->sp;
+
+        stack_sampler_reads[i].thread = (uint32_t) (uintptr_t) tcb;
+        stack_sampler_reads[i].depth  = end - sp;
+        stack_sampler_reads[i].size   = tcb->stack_size;
+
+        // Also skips a thread whose SP is already out of bounds; the
+        // overflow will be reported by the RTOS, not here.
+        if (!start || sp < start || sp > end) stack_sampler_reads[i].size = 0;
+    }
+
+    osKernelUnlock();
+
+    stack_sampler_generation++;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const stack_sampler_read_t * read = &stack_sampler_reads[i];
+
+#if DEBUG_QUANTILES
+        const stack_sampler_slot_t * known = stack_sampler_slot(read->thread, false);
+
+        if (known) sketch = known->depth_sketch;
+        else       memset(&sketch, 0, sizeof(sketch));
+
+        if (read->size) quantile_add(&sketch, read->depth);
+#endif
+
+        osKernelLock();
+
+        // A skipped thread keeps its slot, so its samples so far survive.
+        stack_sampler_slot_t * slot = stack_sampler_slot(read->thread, true);
+
+        if (slot)
+        {
+            slot->generation = stack_sampler_generation;
+
+            if (read->size) stack_sampler_add(slot, read->depth, read->size);
+            else            slot->skipped++;
+
+#if DEBUG_QUANTILES
+            slot->depth_sketch = sketch;
+#endif
+        }
+
+        osKernelUnlock();
+    }
+
+    // Forget threads that have gone, so one reusing the id starts afresh.
+    // Threads left out of a truncated enumeration have not gone.
+    if (count < total) return;
+
+    osKernelLock();
+
+    for (uint32_t i = 0; i < MEMORY_STATUS_MAX_THREADS; i++)
+    {
+        if (stack_sampler_slots[i].generation != stack_sampler_generation) stack_sampler_slots[i].thread = 0;
+    }
+
+    osKernelUnlock();
+}
+
+// Depth below which percent of the samples fall, rounded up to the end of
+// the bucket but never more than the deepest sample.
+static uint32_t stack_sampler_percentile(const stack_sampler_slot_t * slot, uint32_t total, uint32_t percent, uint32_t size)
+{
+    uint32_t target = (uint32_t) (((uint64_t) total * percent + 99) / 100);
+    uint32_t seen   = 0;
+
+    for (uint32_t i = 0; i < STACK_SAMPLER_BUCKETS; i++)
+    {
+        seen += slot->depth[i];
+
+        if (seen >= target)
+        {
+            uint32_t depth = (uint32_t) (((uint64_t) (i + 1) * size) / STACK_SAMPLER_BUCKETS);
+
+            return depth < slot->max ? depth : slot->max;
+        }
+    }
+
+    return slot->max;
+}
+
+// Printed on its own line below the thread, once it has been sampled.
+static void print_thread_stack_depth(const memory_status_thread_t * thread)
+{
+    stack_sampler_slot_t slot;
+    bool                 found = false;
+
+    report_lock();
+
+    const stack_sampler_slot_t * live = stack_sampler_slot(thread->id, false);
+
+    if (live)
+    {
+        slot  = *live;
+        found = true;
+    }
+
+    report_unlock();
+
+    if (!found || !thread->stack_size) return;
+
+    uint32_t total = 0;
+
+    for (uint32_t i = 0; i < STACK_SAMPLER_BUCKETS; i++) total += slot.depth[i];
+
+    DPL("      depth ( p50: ");
+    debug_print_u32(stack_sampler_percentile(&slot, total, 50, thread->stack_size));
+
+    DPL(" p99: ");
+    debug_print_u32(stack_sampler_percentile(&slot, total, 99, thread->stack_size));
+
+    DPL(" max: ");
+    debug_print_u32(slot.max);
+
+    DPL(" samples: ");
+    debug_print_u32(slot.samples);
+
+    DPL(" skipped: ");
+    debug_print_u32(slot.skipped);
+
+    DPL(" )\r\n");
+
+#if DEBUG_QUANTILES
+    print_quantile_sketch("      depth", &slot.depth_sketch);
+#endif
+}
+#endif // DEBUG_STACK_SAMPLER
+
+static void print_thread_overflow(uint32_t missing)
+{
+    DPL("    (");
+    debug_print_u32(missing);
+    DPL(" more threads, raise MEMORY_STATUS_MAX_THREADS)\r\n");
+}
+
+// Printing happens after the threads have been collected, so that the
+// (slow) output is never done with the kernel locked.
+static memory_status_thread_t report_threads[MEMORY_STATUS_MAX_THREADS];
+
+void print_all_thread_info(void)
+{
+    cost_begin();
+
+    uint32_t threadTotal = 0;
+    uint32_t threadCount = rtos_traits::snapshot_threads(report_threads, MEMORY_STATUS_MAX_THREADS, &threadTotal);
+
+#if DEBUG_THREAD_CPU_TIME
+    if (!thread_slots_started) thread_slots_start();
+
+    uint32_t now    = DWT->CYCCNT;
+    uint32_t window = now - cpu_time_last_report;
+
+    cpu_time_last_report = now;
+#endif
+
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        print_thread_fields<rtos_traits>(&report_threads[i]);
+
+#if DEBUG_THREAD_CPU_TIME
+        print_thread_cpu_load(&report_threads[i], window);
+#endif
+
+        DPL("\r\n");
+
+#if DEBUG_SCHED_LATENCY
+        print_thread_sched_latency(&report_threads[i]);
+#endif
+
+#if DEBUG_STACK_SAMPLER
+        print_thread_stack_depth(&report_threads[i]);
+#endif
+    }
+
+    if (threadTotal > threadCount)
+    {
+        print_thread_overflow(threadTotal - threadCount);
+    }
+
+#if DEBUG_THREAD_CPU_TIME || DEBUG_SCHED_LATENCY
+    // With threads missing from the report, dead ones cannot be told apart.
+    if (threadTotal == threadCount) thread_slots_sweep(report_threads, threadCount);
+#endif
+
+#if DEBUG_CONTENTION
+    print_contention_info();
+#endif
+
+    cost_end();
+}
+
+void print_current_thread_id(void)
+{
+    DPL("Current thread: ");
+    debug_print_pointer(osThreadGetId());
+    DPL("\r\n");
+}
+#endif // MEMORY_STATUS_RTOS != MEMORY_STATUS_RTOS_NONE
+
+#if DEBUG_MEMORY_CONTENTS || DEBUG_RTT_COMMANDS
+static void print_memory_contents(const uint32_t * start, const uint32_t * end)
+{
+    uint8_t line = 0;
+
+    for (; start < end; start++)
+    {
+        if (0 == line)
+        {
+            debug_print_pointer(start);
+            DPL(": ");
+        }
+
+        debug_print_u32(*start);
+
+        line++;
+
+        if (16 == line)
+        {
+            DPL("\r\n");
+            line = 0;
+        }
+    }
+}
+#endif
+
+extern uint32_t mbed_stack_isr_size;
+
+#if DEBUG_ISR_STACK_USAGE
+uint32_t calculate_isr_stack_usage(void)
+{
+    for (const uint32_t * stack = &__StackLimit; stack < &__StackTop; stack++)
+    {
+        if (*stack != ISR_STACK_CANARY)
+        {
+            return (uint32_t) (uintptr_t) &__StackTop - (uint32_t) (uintptr_t) stack;
+        }
+    }
+
+    return mbed_stack_isr_size;
+}
+#endif
+
+static void snapshot_heap(memory_status_heap_t * heap)
+{
+    extern unsigned char * mbed_heap_start;
+    extern uint32_t        mbed_heap_size;
+
+    mbed_stats_heap_t      heap_stats;
+
+    mbed_stats_heap_get(&heap_stats);
+
+    heap->start          = (uint32_t) (uintptr_t) mbed_heap_start;
+    heap->end            = (uint32_t) (uintptr_t) (mbed_heap_start + mbed_heap_size);
+    heap->size           = mbed_heap_size;
+    heap->current_size   = heap_stats.current_size;
+    heap->max_size       = heap_stats.max_size;
+    heap->total_size     = heap_stats.total_size;
+    heap->alloc_cnt      = heap_stats.alloc_cnt;
+    heap->alloc_fail_cnt = heap_stats.alloc_fail_cnt;
+}
+
+static void snapshot_isr_stack(memory_status_isr_stack_t * isr_stack)
+{
+    extern unsigned char * mbed_stack_isr_start;
+
+    isr_stack->start = (uint32_t) (uintptr_t) mbed_stack_isr_start;
+    isr_stack->end   = (uint32_t) (uintptr_t) (mbed_stack_isr_start + mbed_stack_isr_size);
+    isr_stack->size  = mbed_stack_isr_size;
+
+#if DEBUG_ISR_STACK_USAGE
+    isr_stack->used  = calculate_isr_stack_usage();
+#else
+    isr_stack->used  = 0;
+#endif
+}
+
+#if MEMORY_STATUS_RTOS == MEMORY_STATUS_RTOS_NONE
+struct no_rtos_traits
+{
+    enum { THREAD_NAMES = 0 };
+
+    static uint32_t snapshot_threads(memory_status_thread_t *, uint32_t, uint32_t * threadTotal)
+    {
+        *threadTotal = 0;
+        return 0;
+    }
+};
+
+typedef no_rtos_traits rtos_traits;
+#endif
+
+template <class Rtos>
+static void snapshot_all(memory_status_snapshot_t * snapshot)
+{
+    snapshot->thread_count = Rtos::snapshot_threads(snapshot->threads, MEMORY_STATUS_MAX_THREADS, &snapshot->thread_total);
+
+    snapshot_heap(&snapshot->heap);
+    snapshot_isr_stack(&snapshot->isr_stack);
+}
+
+void memory_status_snapshot(memory_status_snapshot_t * snapshot)
+{
+    snapshot_all<rtos_traits>(snapshot);
+}
+
+static void print_heap_line(const memory_status_heap_t * heap)
+{
+    DPL("     heap ( start: ");
+    debug_print_u32(heap->start);
+
+    DPL(" end: ");
+    debug_print_u32(heap->end);
+
+    DPL(" size: ");
+    debug_print_u32(heap->size);
+
+    DPL(" used: ");
+    debug_print_u32(heap->max_size);
+
+    DPL(" )  alloc ( ok: ");
+    debug_print_u32(heap->alloc_cnt);
+
+    DPL("  fail: ");
+    debug_print_u32(heap->alloc_fail_cnt);
+
+    DPL(" )\r\n");
+}
+
+static void print_isr_stack_line(const memory_status_isr_stack_t * isr_stack)
+{
+    DPL("isr_stack ( start: ");
+    debug_print_u32(isr_stack->start);
+
+    DPL(" end: ");
+    debug_print_u32(isr_stack->end);
+
+    DPL(" size: ");
+    debug_print_u32(isr_stack->size);
+
+#if DEBUG_ISR_STACK_USAGE
+    DPL(" used: ");
+    debug_print_u32(isr_stack->used);
+#endif
+
+    DPL(" )\r\n");
+}
+
+#if DEBUG_ALLOC_LIFETIME || DEBUG_ALLOC_TAGS
+// Block tables
+//
+// Per-block bookkeeping that leaves the block itself alone: an
+// open-addressed hash keyed by block address, one word of payload per
+// block. Linear probing with backward-shift deletion, so the table never
+// fills up with tombstones. Callers hold a critical section.
+
+typedef struct
+{
+    uint32_t block;
+    uint32_t value;
+} block_entry_t;
+
+typedef struct
+{
+    block_entry_t * entries;
+    uint32_t        mask;       // Entry count - 1, a power of two.
+    uint32_t        untracked;  // Inserts that found the table full.
+} block_table_t;
+
+static uint32_t block_table_home(const block_table_t * table, uint32_t block)
+{
+    return (((block >> 3) * 2654435761UL) >> 16) & table->mask;
+}
+
+static block_entry_t * block_table_find(block_table_t * table, uint32_t block)
+{
+    uint32_t index = block_table_home(table, block);
+
+    for (uint32_t probes = table->mask + 1; probes; probes--)
+    {
+        block_entry_t * entry = &table->entries[index];
+
+        if (entry->block == block) return entry;
+        if (!entry->block)         return NULL;
+
+        index = (index + 1) & table->mask;
+    }
+
+    return NULL;
+}
+
+static bool block_table_insert(block_table_t * table, uint32_t block, uint32_t value)
+{
+    uint32_t index = block_table_home(table, block);
+
+    for (uint32_t probes = table->mask + 1; probes; probes--)
+    {
+        block_entry_t * entry = &table->entries[index];
+
+        if (!entry->block)
+        {
+            entry->block = block;
+            entry->value = value;
+            return true;
+        }
+
+        index = (index + 1) & table->mask;
+    }
+
+    table->untracked++;
+    return false;
+}
+
+static void block_table_remove(block_table_t * table, block_entry_t * entry)
+{
+    uint32_t hole = (uint32_t) (entry - table->entries);
+    uint32_t next = hole;
+
+    for (;;)
+    {
+        table->entries[hole].block = 0;
+
+        for (;;)
+        {
+            next = (next + 1) & table->mask;
+
+            if (!table->entries[next].block) return;
+
+            // Stays put if its home lies cyclically in (hole, next].
+            uint32_t home = block_table_home(table, table->entries[next].block);
+
+            if (((next - home) & table->mask) < ((next - hole) & table->mask)) continue;
+
+            table->entries[hole] = table->entries[next];
+            hole = next;
+            break;
+        }
+    }
+}
+#endif // DEBUG_ALLOC_LIFETIME || DEBUG_ALLOC_TAGS
+
+#if DEBUG_ALLOC_LIFETIME
+// Allocation lifetime
+//
+// mbed's memory tracing callback (MBED_MEM_TRACING_ENABLED=1) sees every
+// malloc / calloc / realloc / free. Each live block gets an entry in a
+// block table with the tick it was allocated at and its size class. On
+// free, the lifetime is counted in a log2 histogram for that size class.
+//
+// The size class goes in the low bits of the tick, so lifetimes longer
+// than about six days alias.
+
+#if !defined (MBED_MEM_TRACING_ENABLED) || !MBED_MEM_TRACING_ENABLED
+#error "DEBUG_ALLOC_LIFETIME needs MBED_MEM_TRACING_ENABLED=1."
+#endif
+
+#include <stdarg.h>
+#include "platform/mbed_mem_trace.h"
+
+#ifndef ALLOC_LIFETIME_SLOTS
+#define ALLOC_LIFETIME_SLOTS   256 // Power of two, 8 bytes each. Live blocks tracked.
+#endif
+
+#ifndef ALLOC_SHORT_LIVED_MS
+#define ALLOC_SHORT_LIVED_MS    16 // Power of two. Shorter: a stack buffer would do.
+#endif
+
+#ifndef ALLOC_LONG_LIVED_MS
+#define ALLOC_LONG_LIVED_MS   1024 // Power of two. Longer: a pool or static is a candidate.
+#endif
+
+enum
+{
+    ALLOC_SIZE_CLASSES = 8,     // <= 16, 32, ... 1024, larger.
+    ALLOC_CLASS_BITS   = 3,
+    ALLOC_LIFETIMES    = 16     // < 1 ms, < 2 ms, ... < 16 s, longer.
+};
+
+typedef struct
+{
+    uint32_t live;
+    uint32_t freed;
+    uint16_t lifetime[ALLOC_LIFETIMES];
+} alloc_size_class_t;
+
+// Values are the tick << ALLOC_CLASS_BITS | size class.
+static block_entry_t      alloc_lifetime_entries[ALLOC_LIFETIME_SLOTS];
+static block_table_t      alloc_lifetime_blocks = { alloc_lifetime_entries, ALLOC_LIFETIME_SLOTS - 1, 0 };
+static alloc_size_class_t alloc_size_classes[ALLOC_SIZE_CLASSES];
+
+#if MEMORY_STATUS_RTOS == MEMORY_STATUS_RTOS_RTX5
+static uint32_t alloc_lifetime_now(void)
+{
+    return osKernelGetTickCount(); // 1 ms with mbed's default tick.
+}
+#else
+#include "hal/us_ticker_api.h"
+
+// us_ticker_read() wraps every 71 minutes, and a millisecond count taken
+// from it directly would too. Extended here to 32 bits of about 1 ms
+// (1024 us) instead; that holds as long as something is allocated or
+// freed at least once per wrap. Only called from the trace callback,
+// which mbed serializes.
+static uint32_t alloc_clock_last_us;
+static uint32_t alloc_clock_ms;
+static uint32_t alloc_clock_rest_us;
+
+static uint32_t alloc_lifetime_now(void)
+{
+    uint32_t now_us  = us_ticker_read();
+    uint32_t elapsed = now_us - alloc_clock_last_us;
+
+    alloc_clock_last_us  = now_us;
+    alloc_clock_rest_us += elapsed & 1023;
+    alloc_clock_ms      += (elapsed >> 10) + (alloc_clock_rest_us >> 10);
+    alloc_clock_rest_us &= 1023;
+
+    return alloc_clock_ms;
+}
+#endif
+
+// 0 for anything up to 1, else how many bits value - 1 needs.
+static uint32_t alloc_log2_ceil(uint32_t value)
+{
+    return value > 1 ? 32 - __CLZ(value - 1) : 0;
+}
+
+static uint32_t alloc_size_class(uint32_t size)
+{
+    uint32_t bits = alloc_log2_ceil(size);
+
+    if (bits < 4) return 0;
+    if (bits - 4 >= ALLOC_SIZE_CLASSES) return ALLOC_SIZE_CLASSES - 1;
+
+    return bits - 4;
+}
+
+static uint32_t alloc_lifetime_bucket(uint32_t ms)
+{
+    uint32_t bucket = ms ? 32 - __CLZ(ms) : 0;
+
+    return bucket < ALLOC_LIFETIMES ? bucket : ALLOC_LIFETIMES - 1;
+}
+
+static void alloc_lifetime_insert(uint32_t block, uint32_t born)
+{
+    if (block_table_insert(&alloc_lifetime_blocks, block, born))
+    {
+        alloc_size_classes[born & ((1 << ALLOC_CLASS_BITS) - 1)].live++;
+    }
+}
+
+static void alloc_lifetime_remove(block_entry_t * entry)
+{
+    alloc_size_classes[entry->value & ((1 << ALLOC_CLASS_BITS) - 1)].live--;
+
+    block_table_remove(&alloc_lifetime_blocks, entry);
+}
+
+static void alloc_lifetime_freed(uint32_t block)
+{
+    block_entry_t * entry = block_table_find(&alloc_lifetime_blocks, block);
+
+    if (!entry) return;
+
+    uint32_t             born     = entry->value & ~((1UL << ALLOC_CLASS_BITS) - 1);
+    uint32_t             lifetime = ((alloc_lifetime_now() << ALLOC_CLASS_BITS) - born) >> ALLOC_CLASS_BITS;
+    alloc_size_class_t * sizes    = &alloc_size_classes[entry->value & ((1 << ALLOC_CLASS_BITS) - 1)];
+    uint32_t             bucket   = alloc_lifetime_bucket(lifetime);
+
+    sizes->freed++;
+
+    if (sizes->lifetime[bucket] != 0xFFFF) sizes->lifetime[bucket]++;
+
+    alloc_lifetime_remove(entry);
+}
+
+static void alloc_lifetime_allocated(uint32_t block, uint32_t size)
+{
+    alloc_lifetime_insert(block, (alloc_lifetime_now() << ALLOC_CLASS_BITS) | alloc_size_class(size));
+}
+
+// Called by mbed's allocation wrappers, serialized by the trace lock.
+static void alloc_lifetime_trace(uint8_t op, void * res, void * caller, ...)
+{
+    va_list args;
+
+    (void) caller;
+
+    va_start(args, caller);
+
+    core_util_critical_section_enter();
+
+    switch (op)
+    {
+        case MBED_MEM_TRACE_MALLOC:
+        {
+            size_t size = va_arg(args, size_t);
+
+            if (res) alloc_lifetime_allocated((uint32_t) (uintptr_t) res, size);
+            break;
+        }
+
+        case MBED_MEM_TRACE_CALLOC:
+        {
+            size_t count = va_arg(args, size_t);
+            size_t size  = va_arg(args, size_t);
+
+            if (res) alloc_lifetime_allocated((uint32_t) (uintptr_t) res, count * size);
+            break;
+        }
+
+        // Keeps the original birth tick, a resized block is still the same
+        // buffer as far as its owner is concerned.
+        case MBED_MEM_TRACE_REALLOC:
+        {
+            void   * ptr  = va_arg(args, void *);
+            size_t   size = va_arg(args, size_t);
+
+            // realloc(ptr, 0) frees ptr.
+            if (!res)
+            {
+                if (ptr && !size) alloc_lifetime_freed((uint32_t) (uintptr_t) ptr);
+                break;
+            }
+
+            block_entry_t * entry = ptr ? block_table_find(&alloc_lifetime_blocks, (uint32_t) (uintptr_t) ptr) : NULL;
+
+            if (entry)
+            {
+                uint32_t born = entry->value & ~((1UL << ALLOC_CLASS_BITS) - 1);
+
+                alloc_lifetime_remove(entry);
+                alloc_lifetime_insert((uint32_t) (uintptr_t) res, born | alloc_size_class(size));
+            }
+            else
+            {
+                alloc_lifetime_allocated((uint32_t) (uintptr_t) res, size);
+            }
+            break;
+        }
+
+        case MBED_MEM_TRACE_FREE:
+        {
+            void * ptr = va_arg(args, void *);
+
+            if (ptr) alloc_lifetime_freed((uint32_t) (uintptr_t) ptr);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    core_util_critical_section_exit();
+
+    va_end(args);
+}
+
+void memory_status_heap_trace_begin(void)
+{
+    mbed_mem_trace_set_callback(alloc_lifetime_trace);
+}
+
+// One line per size class that has seen a free.
+static void print_alloc_lifetime_info(void)
+{
+    static alloc_size_class_t sizes[ALLOC_SIZE_CLASSES];
+    uint32_t                  untracked;
+
+    core_util_critical_section_enter();
+    memcpy(sizes, alloc_size_classes, sizeof(sizes));
+    untracked = alloc_lifetime_blocks.untracked;
+    core_util_critical_section_exit();
+
+    uint32_t short_buckets = alloc_lifetime_bucket(ALLOC_SHORT_LIVED_MS);
+    uint32_t long_buckets  = alloc_lifetime_bucket(ALLOC_LONG_LIVED_MS);
+
+    for (uint32_t c = 0; c < ALLOC_SIZE_CLASSES; c++)
+    {
+        const alloc_size_class_t * size = &sizes[c];
+        uint32_t                   total = 0, short_lived = 0, long_lived = 0, buckets = ALLOC_LIFETIMES;
+
+        for (uint32_t b = 0; b < ALLOC_LIFETIMES; b++)
+        {
+            total += size->lifetime[b];
+
+            if (b <  short_buckets) short_lived += size->lifetime[b];
+            if (b >= long_buckets)  long_lived  += size->lifetime[b];
+        }
+
+        if (!total) continue;
+
+        while (0 == size->lifetime[buckets - 1]) buckets--;
+
+        DPL(" lifetime ( size: ");
+        debug_print_u32(c == ALLOC_SIZE_CLASSES - 1 ? 0xFFFFFFFF : 16UL << c);
+
+        DPL(" freed: ");
+        debug_print_u32(size->freed);
+
+        DPL(" live: ");
+        debug_print_u32(size->live);
+
+        DPL(" short: ");
+        debug_print_percent(short_lived * 100 / total);
+
+        DPL(" long: ");
+        debug_print_percent(long_lived * 100 / total);
+
+        DPL(" ) log2 ms:");
+
+        for (uint32_t b = 0; b < buckets; b++)
+        {
+            DPL(" ");
+            debug_print_u16(size->lifetime[b]);
+        }
+
+        DPL("\r\n");
+    }
+
+    if (untracked)
+    {
+        DPL(" (");
+        debug_print_u32(untracked);
+        DPL(" blocks not tracked, raise ALLOC_LIFETIME_SLOTS)\r\n");
+    }
+}
+#endif // DEBUG_ALLOC_LIFETIME
+
+#if DEBUG_ALLOC_LATENCY || DEBUG_ALLOC_TAGS
+// Allocator wrappers
+//
+// malloc(), free(), realloc() and calloc() are wrapped at link time
+// (-Wl,--wrap=malloc -Wl,--wrap=free -Wl,--wrap=realloc -Wl,--wrap=calloc),
+// outside mbed's own wrappers that keep mbed_stats_heap_t. C++ new and
+// delete end up there too. The wrappers themselves come after the
+// features they feed.
+
+enum
+{
+    ALLOC_OP_MALLOC,
+    ALLOC_OP_FREE,
+    ALLOC_OP_REALLOC,
+    ALLOC_OP_CALLOC,
+    ALLOC_OPS
+};
+#endif
+
+#if DEBUG_ALLOC_LATENCY
+// Allocator latency
+//
+// Each call through the allocator wrappers below is timed with the DWT
+// cycle counter, heap lock and statistics included, as that is what the
+// caller waits for. Per operation there is a log2 histogram, plus the
+// worst case and who made that call.
+
+#if !defined (DWT_CTRL_CYCCNTENA_Msk)
+#error "DEBUG_ALLOC_LATENCY needs the DWT cycle counter (Cortex-M3 and up)."
+#endif
+
+#ifndef ALLOC_LATENCY_BUCKETS
+#define ALLOC_LATENCY_BUCKETS  16
+#endif
+
+#ifndef ALLOC_LATENCY_SHIFT
+#define ALLOC_LATENCY_SHIFT     6 // Bucket 0 is everything below 64 cycles.
+#endif
+
+static const char * const ALLOC_OP_LABEL[ALLOC_OPS] = { "   malloc", "     free", "  realloc", "   calloc" };
+
+typedef struct
+{
+    uint32_t calls;
+    uint32_t max;
+    uint32_t max_caller;
+    uint16_t latency[ALLOC_LATENCY_BUCKETS];
+} alloc_latency_t;
+
+static alloc_latency_t alloc_latency[ALLOC_OPS];
+static bool            alloc_latency_started = false;
+
+static uint32_t alloc_latency_start(void)
+{
+    if (!alloc_latency_started)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+        alloc_latency_started = true;
+    }
+
+    return DWT->CYCCNT;
+}
+
+static void alloc_latency_record(uint32_t op, uint32_t start, void * caller)
+{
+    uint32_t cycles = DWT->CYCCNT - start;
+    uint32_t scaled = cycles >> ALLOC_LATENCY_SHIFT;
+    uint32_t bucket = scaled ? 32 - __CLZ(scaled) : 0;
+
+    if (bucket >= ALLOC_LATENCY_BUCKETS) bucket = ALLOC_LATENCY_BUCKETS - 1;
+
+    core_util_critical_section_enter();
+
+    alloc_latency_t * latency = &alloc_latency[op];
+
+    latency->calls++;
+
+    if (latency->latency[bucket] != 0xFFFF) latency->latency[bucket]++;
+
+    if (cycles > latency->max)
+    {
+        latency->max        = cycles;
+        latency->max_caller = (uint32_t) (uintptr_t) caller;
+    }
+
+    core_util_critical_section_exit();
+}
+
+// One line per operation that has been called. Trailing empty buckets are
+// left out.
+static void print_alloc_latency_info(void)
+{
+    static alloc_latency_t latencies[ALLOC_OPS];
+
+    core_util_critical_section_enter();
+    memcpy(latencies, alloc_latency, sizeof(latencies));
+    core_util_critical_section_exit();
+
+    for (uint32_t op = 0; op < ALLOC_OPS; op++)
+    {
+        const alloc_latency_t * latency = &latencies[op];
+        uint32_t                buckets = ALLOC_LATENCY_BUCKETS;
+
+        if (!latency->calls) continue;
+
+        while (buckets > 1 && 0 == latency->latency[buckets - 1]) buckets--;
+
+        DPL(ALLOC_OP_LABEL[op]);
+        DPL(" ( calls: ");
+        debug_print_u32(latency->calls);
+
+        DPL(" max: ");
+        debug_print_u32(latency->max);
+
+        DPL(" caller: ");
+        debug_print_u32(latency->max_caller);
+
+        DPL(" ) log2:");
+
+        for (uint32_t b = 0; b < buckets; b++)
+        {
+            DPL(" ");
+            debug_print_u16(latency->latency[b]);
+        }
+
+        DPL("\r\n");
+    }
+}
+#else
+static inline uint32_t alloc_latency_start(void) { return 0; }
+static inline void     alloc_latency_record(uint32_t, uint32_t, void *) {}
+#endif // DEBUG_ALLOC_LATENCY
+
+#if DEBUG_ALLOC_QUOTAS && !DEBUG_ALLOC_TAGS
+#error "DEBUG_ALLOC_QUOTAS are per tag; also set DEBUG_ALLOC_TAGS=1."
+#endif
+
+#if DEBUG_ALLOC_TAGS
+// Allocation tags
+//
+// MemTagScope sets the calling thread's current tag for as long as it is
+// in scope, and restores the previous one after. The allocator wrappers
+// below charge every block to the tag current at allocation. A block
+// table remembers its tag and size until it is freed, so frees from any
+// thread are credited back correctly.
+
+#ifndef MEMORY_STATUS_MAX_TAGS
+#define MEMORY_STATUS_MAX_TAGS  16 // Including "untagged".
+#endif
+
+#ifndef ALLOC_TAG_SLOTS
+#define ALLOC_TAG_SLOTS        256 // Power of two, 8 bytes each. Live blocks tracked.
+#endif
+
+#ifndef ALLOC_TAG_THREADS
+#define ALLOC_TAG_THREADS       16 // Power of two, 8 bytes each. Threads with a tag set.
+#endif
+
+enum
+{
+    ALLOC_TAG_BITS = 8,        // Block table value: size << ALLOC_TAG_BITS | tag.
+    ALLOC_TAG_NONE = MEMORY_STATUS_MAX_TAGS
+};
+
+typedef struct
+{
+    uint32_t live;
+    uint32_t peak;
+    uint32_t allocs;
+#if DEBUG_ALLOC_QUOTAS
+    uint32_t denied;
+#endif
+} alloc_tag_stats_t;
+
+typedef struct
+{
+    uint32_t thread;
+    uint32_t tag;
+} alloc_tag_thread_t;
+
+static const char *       alloc_tag_names[MEMORY_STATUS_MAX_TAGS] = { "untagged" };
+static uint32_t           alloc_tag_count = 1;
+static uint32_t           alloc_tag_refused = 0;    // Names that found the table full.
+static uint32_t           alloc_tag_overflows = 0;  // Scopes that found alloc_tag_threads full.
+static alloc_tag_stats_t  alloc_tag_stats[MEMORY_STATUS_MAX_TAGS];
+static alloc_tag_thread_t alloc_tag_threads[ALLOC_TAG_THREADS];
+static block_entry_t      alloc_tag_entries[ALLOC_TAG_SLOTS];
+static block_table_t      alloc_tag_blocks = { alloc_tag_entries, ALLOC_TAG_SLOTS - 1, 0 };
+
+// Entries neither used nor promised. Each allocation takes its promise
+// before calling the allocator, so the insert afterwards cannot fail.
+static volatile uint32_t  alloc_tag_entries_free = ALLOC_TAG_SLOTS;
+
+#if DEBUG_ALLOC_QUOTAS
+typedef struct
+{
+    uint32_t tag;
+    uint32_t size;
+    uint32_t live;
+    uint32_t caller;
+} alloc_quota_denial_t;
+
+// Bytes per tag, unlimited until set. Tag 0 here, the others on creation.
+static uint32_t             alloc_tag_quota[MEMORY_STATUS_MAX_TAGS] = { 0xFFFFFFFF };
+static alloc_quota_denial_t alloc_quota_last;
+#endif
+
+// An SVC on CMSIS-RTOS 1, which escalates to HardFault with interrupts
+// masked: always read it before entering the critical section.
+static uint32_t alloc_tag_thread_id(void)
+{
+#if MEMORY_STATUS_RTOS != MEMORY_STATUS_RTOS_NONE
+    return (uint32_t) (uintptr_t) osThreadGetId();
+#else
+    return 1;
+#endif
+}
+
+static uint32_t alloc_tag_thread_home(uint32_t thread)
+{
+    return (thread >> 3) & (ALLOC_TAG_THREADS - 1);
+}
+
+// Hashed on the thread id like thread_slot(), as every allocation looks
+// its thread up. Must be called inside a critical section. NULL if the
+// thread has no tag set and claim is false, or there is no room.
+static alloc_tag_thread_t * alloc_tag_thread(uint32_t thread, bool claim)
+{
+    uint32_t index = alloc_tag_thread_home(thread);
+
+    if (!thread) return NULL;
+
+    for (uint32_t probes = ALLOC_TAG_THREADS; probes; probes--)
+    {
+        alloc_tag_thread_t * entry = &alloc_tag_threads[index];
+
+        if (entry->thread == thread) return entry;
+
+        if (!entry->thread)
+        {
+            if (!claim) return NULL;
+
+            entry->thread = thread;
+            entry->tag    = 0;
+            return entry;
+        }
+
+        index = (index + 1) & (ALLOC_TAG_THREADS - 1);
+    }
+
+    return NULL;
+}
+
+// Must be called inside a critical section. Same backward shift as
+// thread_slot_release().
+static void alloc_tag_thread_release(alloc_tag_thread_t * entry)
+{
+    uint32_t hole = (uint32_t) (entry - alloc_tag_threads);
+    uint32_t next = hole;
+
+    for (uint32_t probes = ALLOC_TAG_THREADS - 1; probes; probes--)
+    {
+        next = (next + 1) & (ALLOC_TAG_THREADS - 1);
+
+        if (!alloc_tag_threads[next].thread) break;
+
+        uint32_t home = alloc_tag_thread_home(alloc_tag_threads[next].thread);
+
+        if (((next - home) & (ALLOC_TAG_THREADS - 1)) >= ((next - hole) & (ALLOC_TAG_THREADS - 1)))
+        {
+            alloc_tag_threads[hole] = alloc_tag_threads[next];
+            hole = next;
+        }
+    }
+
+    alloc_tag_threads[hole].thread = 0;
+    alloc_tag_threads[hole].tag    = 0;
+}
+
+// A thread that exits inside a scope leaves its entry behind, and the next
+// thread created may get the same control block and so the same id.
+static void alloc_tag_thread_destroyed(void * thread)
+{
+    core_util_critical_section_enter();
+
+    alloc_tag_thread_t * entry = alloc_tag_thread((uint32_t) (uintptr_t) thread, false);
+
+    if (entry) alloc_tag_thread_release(entry);
+
+    core_util_critical_section_exit();
+}
+
+// Tags are normally string literals, so the pointer compare nearly always
+// hits. ALLOC_TAG_NONE for NULL, and, counted, for a new name once the
+// table is full.
+static uint32_t alloc_tag_id(const char * name)
+{
+    uint32_t tag = 0;
+
+    if (!name) return ALLOC_TAG_NONE;
+
+    core_util_critical_section_enter();
+
+    for (uint32_t i = 1; i < alloc_tag_count && !tag; i++)
+    {
+        if (alloc_tag_names[i] == name || 0 == strcmp(alloc_tag_names[i], name)) tag = i;
+    }
+
+    if (!tag && alloc_tag_count < MEMORY_STATUS_MAX_TAGS)
+    {
+        tag = alloc_tag_count++;
+        alloc_tag_names[tag] = name;
+
+#if DEBUG_ALLOC_QUOTAS
+        alloc_tag_quota[tag] = 0xFFFFFFFF;
+#endif
+    }
+
+    if (!tag)
+    {
+        tag = ALLOC_TAG_NONE;
+        alloc_tag_refused++;
+    }
+
+    core_util_critical_section_exit();
+
+    return tag;
+}
+
+static uint32_t alloc_tag_current(void);
+
+// A NULL name leaves the current tag as it is. A name that found the table
+// full is charged to "untagged". A thread that finds alloc_tag_threads full
+// keeps its current tag, and gets MEMORY_STATUS_TAG_ERROR.
+uint32_t memory_status_tag_enter(const char * name)
+{
+    if (!name) return alloc_tag_current();
+
+    uint32_t tag      = alloc_tag_id(name);
+    uint32_t self     = alloc_tag_thread_id();
+    uint32_t previous = 0;
+
+    if (tag == ALLOC_TAG_NONE) tag = 0;
+
+    core_util_critical_section_enter();
+
+    alloc_tag_thread_t * thread = alloc_tag_thread(self, true);
+
+    if (thread)
+    {
+        previous    = thread->tag;
+        thread->tag = tag;
+    }
+    else if (self)
+    {
+        previous = MEMORY_STATUS_TAG_ERROR;
+        alloc_tag_overflows++;
+    }
+
+    core_util_critical_section_exit();
+
+    return previous;
+}
+
+void memory_status_tag_leave(uint32_t previous)
+{
+    if (previous == MEMORY_STATUS_TAG_ERROR) return;
+
+    uint32_t self = alloc_tag_thread_id();
+
+    core_util_critical_section_enter();
+
+    alloc_tag_thread_t * thread = alloc_tag_thread(self, false);
+
+    if (thread)
+    {
+        thread->tag = previous;
+
+        // Back to untagged, give the entry back.
+        if (!previous) alloc_tag_thread_release(thread);
+    }
+
+    core_util_critical_section_exit();
+}
+
+#if DEBUG_ALLOC_QUOTAS
+// Refused, rather than put on "untagged", when the tag table is full.
+bool memory_status_tag_quota(const char * name, uint32_t bytes)
+{
+    uint32_t tag = name ? alloc_tag_id(name) : 0;
+
+    if (tag == ALLOC_TAG_NONE) return false;
+
+    alloc_tag_quota[tag] = bytes ? bytes : 0xFFFFFFFF;
+
+    return true;
+}
+#endif
+
+static uint32_t alloc_tag_current(void)
+{
+    uint32_t self = alloc_tag_thread_id();
+
+    core_util_critical_section_enter();
+
+    alloc_tag_thread_t * thread = alloc_tag_thread(self, false);
+    uint32_t             tag    = thread ? thread->tag : 0;
+
+    core_util_critical_section_exit();
+
+    return tag;
+}
+
+#if DEBUG_ALLOC_QUOTAS
+static void alloc_quota_deny(uint32_t tag, uint32_t size, uint32_t live, void * caller)
+{
+    core_util_critical_section_enter();
+
+    alloc_tag_stats[tag].denied++;
+
+    alloc_quota_last.tag    = tag;
+    alloc_quota_last.size   = size;
+    alloc_quota_last.live   = live - size;
+    alloc_quota_last.caller = (uint32_t) (uintptr_t) caller;
+
+    core_util_critical_section_exit();
+}
+#endif
+
+// Promises a block table entry to the caller. false if all are taken.
+static bool alloc_tag_entry_take(void)
+{
+    if ((int32_t) core_util_atomic_decr_u32(&alloc_tag_entries_free, 1) >= 0) return true;
+
+    core_util_atomic_incr_u32(&alloc_tag_entries_free, 1);
+
+    return false;
+}
+
+// Charges size to tag before the allocator runs. With quotas, that makes
+// the check one atomic add and one compare, and two threads cannot both
+// squeeze under the limit. false if the tag would go over its quota.
+//
+// *tracked says whether a block table entry was promised too. A block
+// without one is not charged at all, which would let a tag with a quota
+// allocate past it, so for those tags it is denied instead.
+static bool alloc_tag_reserve(uint32_t tag, uint32_t size, void * caller, bool * tracked)
+{
+    *tracked = alloc_tag_entry_take();
+
+#if DEBUG_ALLOC_QUOTAS
+    if (!*tracked && alloc_tag_quota[tag] != 0xFFFFFFFF)
+    {
+        core_util_critical_section_enter();
+        alloc_tag_blocks.untracked++;
+        core_util_critical_section_exit();
+
+        alloc_quota_deny(tag, size, alloc_tag_stats[tag].live + size, caller);
+        return false;
+    }
+#endif
+
+    uint32_t live = core_util_atomic_incr_u32(&alloc_tag_stats[tag].live, size);
+
+#if DEBUG_ALLOC_QUOTAS
+    if (live > alloc_tag_quota[tag])
+    {
+        core_util_atomic_decr_u32(&alloc_tag_stats[tag].live, size);
+
+        if (*tracked) core_util_atomic_incr_u32(&alloc_tag_entries_free, 1);
+
+        alloc_quota_deny(tag, size, live, caller);
+        return false;
+    }
+#else
+    (void) live;
+    (void) caller;
+#endif
+
+    return true;
+}
+
+// After the allocator ran: remembers the block, or hands the reservation
+// and the promised entry back if there is no block, or no entry for it.
+static void alloc_tag_commit(void * block, uint32_t size, uint32_t tag, bool counts, bool tracked)
+{
+    core_util_critical_section_enter();
+
+    alloc_tag_stats_t * stats = &alloc_tag_stats[tag];
+
+    if (block && counts) stats->allocs++;
+
+    if (block && tracked && block_table_insert(&alloc_tag_blocks, (uint32_t) (uintptr_t) block, (size << ALLOC_TAG_BITS) | tag))
+    {
+        if (stats->live > stats->peak) stats->peak = stats->live;
+    }
+    else
+    {
+        stats->live -= size;
+
+        if (tracked) alloc_tag_entries_free++;
+
+        if (block && !tracked) alloc_tag_blocks.untracked++;
+    }
+
+    core_util_critical_section_exit();
+}
+
+// Removes the block's entry before the allocator gets to reuse the
+// address. Returns the entry's value, 0 if the block was not tracked.
+static uint32_t alloc_tag_release(void * ptr)
+{
+    uint32_t value = 0;
+
+    if (!ptr) return 0;
+
+    core_util_critical_section_enter();
+
+    block_entry_t * entry = block_table_find(&alloc_tag_blocks, (uint32_t) (uintptr_t) ptr);
+
+    if (entry)
+    {
+        value = entry->value;
+
+        alloc_tag_stats[value & ((1 << ALLOC_TAG_BITS) - 1)].live -= value >> ALLOC_TAG_BITS;
+        block_table_remove(&alloc_tag_blocks, entry);
+
+        alloc_tag_entries_free++;
+    }
+
+    core_util_critical_section_exit();
+
+    return value;
+}
+
+static inline uint32_t alloc_tag_of(uint32_t released)
+{
+    return released & ((1 << ALLOC_TAG_BITS) - 1);
+}
+
+// Undoes alloc_tag_release() when realloc() left the block where it was.
+static void alloc_tag_restore(void * block, uint32_t released)
+{
+    if (!released) return;
+
+    uint32_t tag     = alloc_tag_of(released);
+    uint32_t size    = released >> ALLOC_TAG_BITS;
+    bool     tracked = alloc_tag_entry_take();
+
+    core_util_atomic_incr_u32(&alloc_tag_stats[tag].live, size);
+    alloc_tag_commit(block, size, tag, false, tracked);
+}
+
+static void print_alloc_tag_info(void)
+{
+    static alloc_tag_stats_t stats[MEMORY_STATUS_MAX_TAGS];
+    uint32_t                 count;
+    uint32_t                 refused;
+    uint32_t                 overflows;
+    uint32_t                 untracked;
+
+#if DEBUG_ALLOC_QUOTAS
+    alloc_quota_denial_t     last;
+#endif
+
+    core_util_critical_section_enter();
+    memcpy(stats, alloc_tag_stats, sizeof(stats));
+    count     = alloc_tag_count;
+    refused   = alloc_tag_refused;
+    overflows = alloc_tag_overflows;
+    untracked = alloc_tag_blocks.untracked;
+#if DEBUG_ALLOC_QUOTAS
+    last      = alloc_quota_last;
+#endif
+    core_util_critical_section_exit();
+
+    for (uint32_t tag = 0; tag < count; tag++)
+    {
+        if (!stats[tag].allocs) continue;
+
+        DPL("      tag ( name: ");
+        DPL(alloc_tag_names[tag]);
+
+        DPL(" live: ");
+        debug_print_u32(stats[tag].live);
+
+        DPL(" peak: ");
+        debug_print_u32(stats[tag].peak);
+
+        DPL(" allocs: ");
+        debug_print_u32(stats[tag].allocs);
+
+#if DEBUG_ALLOC_QUOTAS
+        if (alloc_tag_quota[tag] != 0xFFFFFFFF)
+        {
+            DPL(" quota: ");
+            debug_print_u32(alloc_tag_quota[tag]);
+
+            DPL(" denied: ");
+            debug_print_u32(stats[tag].denied);
+        }
+#endif
+
+        DPL(" )\r\n");
+    }
+
+#if DEBUG_ALLOC_QUOTAS
+    if (last.size)
+    {
+        DPL("    quota ( tag: ");
+        DPL(alloc_tag_names[last.tag]);
+
+        DPL(" size: ");
+        debug_print_u32(last.size);
+
+        DPL(" live: ");
+        debug_print_u32(last.live);
+
+        DPL(" caller: ");
+        debug_print_u32(last.caller);
+
+        DPL(" ) last denied\r\n");
+    }
+#endif
+
+    if (refused)
+    {
+        DPL("      (");
+        debug_print_u32(refused);
+        DPL(" tag names refused, raise MEMORY_STATUS_MAX_TAGS)\r\n");
+    }
+
+    if (overflows)
+    {
+        DPL("      (");
+        debug_print_u32(overflows);
+        DPL(" tag scopes refused, raise ALLOC_TAG_THREADS)\r\n");
+    }
+
+    if (untracked)
+    {
+        DPL("      (");
+        debug_print_u32(untracked);
+        DPL(" blocks not tracked, raise ALLOC_TAG_SLOTS)\r\n");
+    }
+}
+#else
+static inline uint32_t alloc_tag_current(void) { return 0; }
+static inline bool     alloc_tag_reserve(uint32_t, uint32_t, void *, bool *) { return true; }
+static inline void     alloc_tag_commit(void *, uint32_t, uint32_t, bool, bool) {}
+static inline uint32_t alloc_tag_release(void *) { return 0; }
+static inline uint32_t alloc_tag_of(uint32_t) { return 0; }
+static inline void     alloc_tag_restore(void *, uint32_t) {}
+#endif // DEBUG_ALLOC_TAGS
+
+#if DEBUG_THREAD_CPU_TIME || DEBUG_SCHED_LATENCY || DEBUG_ALLOC_TAGS
+void memory_status_thread_destroyed(void * thread)
+{
+#if DEBUG_THREAD_CPU_TIME || DEBUG_SCHED_LATENCY
+    thread_slot_destroyed(thread);
+#endif
+#if DEBUG_ALLOC_TAGS
+    alloc_tag_thread_destroyed(thread);
+#endif
+}
+
+#if MEMORY_STATUS_THREAD_EVENTS
+// Called by RTX5 when a thread's control block is freed, with the same
+// preconditions as EvrRtxThreadSwitched(). With DEBUG_ALLOC_TAGS alone
+// and the events off, call memory_status_thread_destroyed() instead.
+extern "C" void EvrRtxThreadDestroyed(osThreadId_t thread_id)
+{
+    memory_status_thread_destroyed(thread_id);
+}
+#endif
+#endif
+
+#if DEBUG_ALLOC_LATENCY || DEBUG_ALLOC_TAGS
+extern "C" void * __real_malloc(size_t size);
+extern "C" void   __real_free(void * ptr);
+extern "C" void * __real_realloc(void * ptr, size_t size);
+extern "C" void * __real_calloc(size_t count, size_t size);
+
+extern "C" void * __wrap_malloc(size_t size)
+{
+    void   * caller  = __builtin_return_address(0);
+    uint32_t tag     = alloc_tag_current();
+    bool     tracked = false;
+
+    if (!alloc_tag_reserve(tag, size, caller, &tracked)) return NULL;
+
+    uint32_t start  = alloc_latency_start();
+    void   * result = __real_malloc(size);
+
+    alloc_latency_record(ALLOC_OP_MALLOC, start, caller);
+    alloc_tag_commit(result, size, tag, true, tracked);
+
+    return result;
+}
+
+extern "C" void __wrap_free(void * ptr)
+{
+    alloc_tag_release(ptr);
+
+    uint32_t start = alloc_latency_start();
+
+    __real_free(ptr);
+
+    alloc_latency_record(ALLOC_OP_FREE, start, __builtin_return_address(0));
+}
+
+// A resized block stays with the tag it was allocated under. When realloc()
+// fails, or is refused, the old block is untouched and so is its entry.
+extern "C" void * __wrap_realloc(void * ptr, size_t size)
+{
+    void   * caller   = __builtin_return_address(0);
+    uint32_t released = alloc_tag_release(ptr);
+    uint32_t tag      = released ? alloc_tag_of(released) : alloc_tag_current();
+    bool     tracked  = false;
+
+    if (!alloc_tag_reserve(tag, size, caller, &tracked))
+    {
+        alloc_tag_restore(ptr, released);
+        return NULL;
+    }
+
+    uint32_t start  = alloc_latency_start();
+    void   * result = __real_realloc(ptr, size);
+
+    alloc_latency_record(ALLOC_OP_REALLOC, start, caller);
+    alloc_tag_commit(result, size, tag, !released, tracked);
+
+    // realloc(ptr, 0) frees ptr, any other NULL leaves it alone.
+    if (!result && size) alloc_tag_restore(ptr, released);
+
+    return result;
+}
+
+// count * size must not wrap: it would be charged, and checked against
+// the quota, as a much smaller block. calloc() itself fails such a call.
+extern "C" void * __wrap_calloc(size_t count, size_t size)
+{
+    if (size && count > (size_t) -1 / size) return NULL;
+
+    void   * caller  = __builtin_return_address(0);
+    uint32_t tag     = alloc_tag_current();
+    bool     tracked = false;
+
+    if (!alloc_tag_reserve(tag, count * size, caller, &tracked)) return NULL;
+
+    uint32_t start  = alloc_latency_start();
+    void   * result = __real_calloc(count, size);
+
+    alloc_latency_record(ALLOC_OP_CALLOC, start, caller);
+    alloc_tag_commit(result, count * size, tag, true, tracked);
+
+    return result;
+}
+#endif // DEBUG_ALLOC_LATENCY || DEBUG_ALLOC_TAGS
+
+static void print_heap_info(void)
+{
+    memory_status_heap_t heap;
+
+    snapshot_heap(&heap);
+    print_heap_line(&heap);
+
+#if DEBUG_QUANTILES
+    quantile_sketch_t sketch;
+
+    report_lock();
+    sketch = heap_sketch;
+    report_unlock();
+
+    print_quantile_sketch("     heap", &sketch);
+#endif
+
+#if DEBUG_ALLOC_LIFETIME
+    print_alloc_lifetime_info();
+#endif
+
+#if DEBUG_ALLOC_LATENCY
+    print_alloc_latency_info();
+#endif
+
+#if DEBUG_ALLOC_TAGS
+    print_alloc_tag_info();
+#endif
+}
+
+static void print_isr_stack_info(void)
+{
+    memory_status_isr_stack_t isr_stack;
+
+    snapshot_isr_stack(&isr_stack);
+    print_isr_stack_line(&isr_stack);
+
+#if DEBUG_MEMORY_CONTENTS
+    // Print ISR stack contents.
+    print_memory_contents(&__StackLimit, &__StackTop);
+#endif
+}
+
+void print_heap_and_isr_stack_info(void)
+{
+    cost_begin();
+
+    print_heap_info();
+    print_isr_stack_info();
+
+    cost_end();
+}
+
+#if DEBUG_FAULT_DUMP
+// Fault dump
+//
+// print_fault_memory_status() is meant to be called from a HardFault or
+// mbed error handler. It makes no RTOS calls and takes no locks: the RTX5
+// thread lists are walked directly from osRtxInfo, the same way
+// osThreadEnumerate() does, and the outputs switch to their lock-free paths.
+// Every loop is bounded (MEMORY_STATUS_MAX_THREADS threads,
+// FAULT_DUMP_MAX_STACK bytes of stack, FAULT_DUMP_WORDS words), so it
+// finishes in bounded time even when the RTOS data structures are corrupt.
+// A TCB is only followed into RAM, and a stack outside RAM or larger than
+// FAULT_DUMP_MAX_STACK marks its TCB as suspect instead of being scanned.
+//
+// Heap statistics are left out, since mbed_stats_heap_get() takes a mutex.
+
+#ifndef FAULT_DUMP_WORDS
+#define FAULT_DUMP_WORDS  128
+#endif
+
+#ifndef FAULT_DUMP_MAX_STACK
+#define FAULT_DUMP_MAX_STACK  0x10000 // Bytes. Larger thread stacks are taken to be corrupt.
+#endif
+
+// RAM, from the GCC_ARM linker script symbols: .data starts at the bottom,
+// the ISR stack ends at the top. Define both for other toolchains.
+#ifndef FAULT_DUMP_RAM_START
+extern uint32_t __data_start__;
+#define FAULT_DUMP_RAM_START  ((uint32_t) (uintptr_t) &__data_start__)
+#endif
+
+#ifndef FAULT_DUMP_RAM_END
+extern uint32_t __StackTop;
+#define FAULT_DUMP_RAM_END    ((uint32_t) (uintptr_t) &__StackTop)
+#endif
+
+// Prints words from start (up to end, at most FAULT_DUMP_WORDS), 8 per line,
+// with runs of a repeated word collapsed into a single line.
+static void print_fault_stack_dump(const uint32_t * start, const uint32_t * end)
+{
+    if (end - start > FAULT_DUMP_WORDS) end = start + FAULT_DUMP_WORDS;
+
+    uint8_t column = 0;
+
+    while (start < end)
+    {
+        const uint32_t * run = start + 1;
+
+        while (run < end && *run == *start) run++;
+
+        if (run - start >= 4)
+        {
+            if (column) DPL("\r\n");
+            column = 0;
+
+            debug_print_pointer(start);
+            DPL(": ");
+            debug_print_u32(*start);
+            DPL(" x ");
+            debug_print_u32((uint32_t) (run - start));
+            DPL("\r\n");
+
+            start = run;
+            continue;
+        }
+
+        if (0 == column)
+        {
+            debug_print_pointer(start);
+            DPL(":");
+        }
+
+        DPL(" ");
+        debug_print_u32(*start++);
+
+        if (8 == ++column)
+        {
+            DPL("\r\n");
+            column = 0;
+        }
+    }
+
+    if (column) DPL("\r\n");
+}
+
+#if MEMORY_STATUS_RTOS == MEMORY_STATUS_RTOS_RTX5
+// Whether size bytes at address are word aligned and all in RAM. Written
+// so that neither sum can wrap.
+static bool fault_in_ram(uint32_t address, uint32_t size)
+{
+    uint32_t ram_start = FAULT_DUMP_RAM_START;
+    uint32_t ram_end   = FAULT_DUMP_RAM_END;
+
+    return !(address & 3) && address >= ram_start && address <= ram_end && size <= ram_end - address;
+}
+
+static bool fault_stack_valid(const os_thread_t * tcb)
+{
+    return tcb->stack_size <= FAULT_DUMP_MAX_STACK && fault_in_ram((uint32_t) (uintptr_t) tcb->stack_mem, tcb->stack_size);
+}
+
+static bool fault_sp_in_stack(uint32_t sp, const os_thread_t * tcb)
+{
+    if (!fault_stack_valid(tcb)) return false;
+
+    return sp >= (uint32_t) (uintptr_t) tcb->stack_mem && sp <= (uint32_t) (uintptr_t) tcb->stack_mem + tcb->stack_size;
+}
+
+static void print_fault_thread(const os_thread_t * tcb, uint32_t sp)
+{
+    uint32_t start = (uint32_t) (uintptr_t) tcb->stack_mem;
+    uint32_t used  = tcb->stack_size;
+
+    if (!fault_stack_valid(tcb))
+    {
+        DPL("    stack ( start: ");
+        debug_print_u32(start);
+
+        DPL(" size: ");
+        debug_print_u32(tcb->stack_size);
+
+        DPL(" ) thread ( id: ");
+        debug_print_pointer(tcb);
+
+        DPL(" ) suspect\r\n");
+        return;
+    }
+
+    // Same as osThreadGetStackSpace(): stack_mem[0] is the magic word, the
+    // rest was filled with the pattern at thread creation.
+    if (osRtxConfig.flags & osRtxConfigStackWatermark)
+    {
+        const uint32_t * stack = (const uint32_t *) tcb->stack_mem;
+        uint32_t         words = tcb->stack_size / 4;
+        uint32_t         i;
+
+        for (i = 1; i < words; i++)
+        {
+            if (stack[i] != osRtxStackFillPattern) break;
+        }
+
+        used = tcb->stack_size - i * 4;
+    }
+
+    DPL("    stack ( start: ");
+    debug_print_u32(start);
+
+    DPL(" end: ");
+    debug_print_u32(start + tcb->stack_size);
+
+    DPL(" size: ");
+    debug_print_u32(tcb->stack_size);
+
+    DPL(" used: ");
+    debug_print_u32(used);
+
+    DPL(" sp: ");
+    debug_print_u32(fault_sp_in_stack(sp, tcb) ? sp : tcb->sp);
+
+    DPL(" ) thread ( id: ");
+    debug_print_pointer(tcb);
+
+    DPL(" entry: ");
+    debug_print_u32(tcb->thread_addr);
+
+    DPL(" state: ");
+    debug_print_u32(tcb->state);
+
+    DPL(" )\r\n");
+}
+
+// Prints one RTX thread list, following thread_next or delay_next. Returns
+// the thread whose stack holds sp, if any. A thread with a bad id ends the
+// walk, so a corrupt list cannot send it off into the weeds.
+static const os_thread_t * print_fault_thread_list(const os_thread_t * thread, bool delay_list, uint32_t sp, uint32_t * budget)
+{
+    const os_thread_t * owner = NULL;
+
+    for (; thread && *budget; thread = delay_list ? thread->delay_next : thread->thread_next)
+    {
+        if (!fault_in_ram((uint32_t) (uintptr_t) thread, sizeof(*thread)) || thread->id != osRtxIdThread)
+        {
+            DPL("    (corrupt thread list)\r\n");
+            break;
+        }
+
+        print_fault_thread(thread, sp);
+
+        if (fault_sp_in_stack(sp, thread)) owner = thread;
+
+        (*budget)--;
+    }
+
+    return owner;
+}
+#endif
+
+void print_fault_memory_status(uint32_t sp)
+{
+    fault_mode = true;
+
+#if OUTPUT_FRAMING
+    frame_reset();
+#endif
+
+    DPL("\r\nfault ( sp: ");
+    debug_print_u32(sp);
+    DPL(" )\r\n");
+
+    const uint32_t * dump_end = NULL;
+
+#if MEMORY_STATUS_RTOS == MEMORY_STATUS_RTOS_RTX5
+    uint32_t            budget  = MEMORY_STATUS_MAX_THREADS;
+    const os_thread_t * owner   = NULL;
+    const os_thread_t * found   = NULL;
+    const os_thread_t * running = osRtxInfo.thread.run.curr;
+
+    // Running thread first, then the same lists osThreadEnumerate() walks.
+    if (running && fault_in_ram((uint32_t) (uintptr_t) running, sizeof(*running)) && running->id == osRtxIdThread)
+    {
+        print_fault_thread(running, sp);
+
+        if (fault_sp_in_stack(sp, running)) owner = running;
+
+        budget--;
+    }
+
+    if ((found = print_fault_thread_list(osRtxInfo.thread.ready.thread_list, false, sp, &budget))) owner = found;
+    if ((found = print_fault_thread_list(osRtxInfo.thread.delay_list,        true,  sp, &budget))) owner = found;
+    if ((found = print_fault_thread_list(osRtxInfo.thread.wait_list,         true,  sp, &budget))) owner = found;
+
+    if (owner)
+    {
+        dump_end = (const uint32_t *) ((uintptr_t) owner->stack_mem + owner->stack_size);
+    }
+#endif
+
+    memory_status_isr_stack_t isr_stack;
+
+    snapshot_isr_stack(&isr_stack);
+    print_isr_stack_line(&isr_stack);
+
+    if (!dump_end && sp >= isr_stack.start && sp <= isr_stack.end)
+    {
+        dump_end = (const uint32_t *) (uintptr_t) isr_stack.end;
+    }
+
+    if (dump_end)
+    {
+        print_fault_stack_dump((const uint32_t *) (uintptr_t) (sp & ~3U), dump_end);
+    }
+}
+#endif // DEBUG_FAULT_DUMP
+
+#if DEBUG_STREAM
+// Pull-based report, for transports whose packet size and timing belong to
+// the application (BLE notifications, USB endpoints, ...):
+//
+//   memory_status_stream_begin(MEMORY_STATUS_STREAM_TEXT);
+//
+//   while ((n = memory_status_stream_read(packet, sizeof(packet))))
+//   {
+//       send(packet, n);
+//   }
+//
+// Text is rendered one line at a time from a snapshot taken at begin, so
+// the report is consistent no matter how slowly it is read out. Binary is
+// rendered the same way, one record at a time, in the layout the README
+// documents: little endian, no padding, names copied rather than pointed
+// to, whatever the target's own struct layout.
+
+static memory_status_snapshot_t stream_snapshot;
+static int                      stream_format = MEMORY_STATUS_STREAM_TEXT;
+static uint32_t                 stream_item   = 0;  // Next line, or binary record, to render.
+static uint32_t                 stream_offset = 0;  // Read position in stream_line.
+
+// Renders the next line of the report into stream_line. Returns false when
+// there are no more lines.
+static bool stream_render_line(void)
+{
+    const memory_status_snapshot_t * snapshot = &stream_snapshot;
+
+    uint32_t item = stream_item++;
+
+    stream_offset = 0;
+
+    stream_capture_begin();
+
+#if MEMORY_STATUS_RTOS != MEMORY_STATUS_RTOS_NONE
+    if (item < snapshot->thread_count)
+    {
+        print_thread_info(&snapshot->threads[item]);
+        stream_capture_end();
+        return true;
+    }
+
+    item -= snapshot->thread_count;
+
+    if (snapshot->thread_total > snapshot->thread_count)
+    {
+        if (item == 0)
+        {
+            print_thread_overflow(snapshot->thread_total - snapshot->thread_count);
+            stream_capture_end();
+            return true;
+        }
+
+        item--;
+    }
+#endif
+
+    if      (item == 0) print_heap_line(&snapshot->heap);
+    else if (item == 1) print_isr_stack_line(&snapshot->isr_stack);
+
+    stream_capture_end();
+
+    return stream_line_length != 0;
+}
+
+static void stream_put_u32(uint32_t value)
+{
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        stream_line[stream_line_length++] = (char) (value >> (8 * i));
+    }
+}
+
+static void stream_put_name(const char * name)
+{
+    uint32_t length = 0;
+
+    while (name && name[length] && length < STREAM_NAME_SIZE) length++;
+
+    stream_line[stream_line_length++] = (char) length;
+
+    memcpy(&stream_line[stream_line_length], name, length);
+    stream_line_length += length;
+}
+
+// Renders the next binary record into stream_line. Returns false when
+// there are no more records.
+static bool stream_render_record(void)
+{
+    const memory_status_snapshot_t * snapshot = &stream_snapshot;
+
+    uint32_t item = stream_item++;
+
+    stream_offset      = 0;
+    stream_line_length = 0;
+
+    if (item == 0)
+    {
+        stream_put_u32(snapshot->thread_count);
+        stream_put_u32(snapshot->thread_total);
+        return true;
+    }
+
+    item--;
+
+    if (item < snapshot->thread_count)
+    {
+        const memory_status_thread_t * thread = &snapshot->threads[item];
+
+        stream_put_u32(thread->stack_start);
+        stream_put_u32(thread->stack_end);
+        stream_put_u32(thread->stack_size);
+        stream_put_u32(thread->stack_used);
+        stream_put_u32(thread->id);
+        stream_put_u32(thread->entry);
+        stream_put_u32((uint32_t) thread->state);
+        stream_put_u32((uint32_t) thread->priority);
+        stream_put_name(thread->name);
+        return true;
+    }
+
+    item -= snapshot->thread_count;
+
+    if (item == 0)
+    {
+        const memory_status_heap_t * heap = &snapshot->heap;
+
+        stream_put_u32(heap->start);
+        stream_put_u32(heap->end);
+        stream_put_u32(heap->size);
+        stream_put_u32(heap->current_size);
+        stream_put_u32(heap->max_size);
+        stream_put_u32(heap->total_size);
+        stream_put_u32(heap->alloc_cnt);
+        stream_put_u32(heap->alloc_fail_cnt);
+    }
+    else if (item == 1)
+    {
+        const memory_status_isr_stack_t * isr_stack = &snapshot->isr_stack;
+
+        stream_put_u32(isr_stack->start);
+        stream_put_u32(isr_stack->end);
+        stream_put_u32(isr_stack->size);
+        stream_put_u32(isr_stack->used);
+    }
+
+    return stream_line_length != 0;
+}
+
+void memory_status_stream_begin(int format)
+{
+    memory_status_snapshot(&stream_snapshot);
+
+    stream_format      = format;
+    stream_item        = 0;
+    stream_offset      = 0;
+    stream_line_length = 0;
+}
+
+uint32_t memory_status_stream_read(void * buffer, uint32_t size)
+{
+    uint8_t * out    = (uint8_t *) buffer;
+    uint32_t  count  = 0;
+    bool      binary = stream_format == MEMORY_STATUS_STREAM_BINARY;
+
+    while (count < size)
+    {
+        if (stream_offset == stream_line_length && !(binary ? stream_render_record() : stream_render_line()))
+        {
+            break;
+        }
+
+        while (count < size && stream_offset < stream_line_length)
+        {
+            out[count++] = (uint8_t) stream_line[stream_offset++];
+        }
+    }
+
+    return count;
+}
+#endif // DEBUG_STREAM
+
+#if DEBUG_FLIGHT_RECORDER
+// Flight recorder
+//
+// memory_status_record() keeps a compact sample in a ring, plus the last full
+// snapshot, in RAM that is not cleared at startup. After a watchdog or fault
+// reset, memory_status_recorder_dump() prints whatever survived. Every part
+// carries its own CRC, and the ring's header is kept twice and written to
+// the older copy, so a reset in the middle of recording only loses the part
+// being written.
+//
+// The linker script needs a NOLOAD output section for FLIGHT_RECORDER_SECTION,
+// otherwise the startup code zeroes (or the linker initializes) it.
+
+#ifndef FLIGHT_RECORDER_SAMPLES
+#define FLIGHT_RECORDER_SAMPLES  16
+#endif
+
+#ifndef FLIGHT_RECORDER_SECTION
+#define FLIGHT_RECORDER_SECTION  ".noinit"
+#endif
+
+static const uint32_t FLIGHT_RECORDER_MAGIC = 0xF117EC0D;
+
+typedef struct
+{
+    uint32_t sequence;
+    uint32_t timestamp;         // Whatever the caller passed in.
+    uint32_t heap_current;
+    uint32_t heap_max;
+    uint32_t alloc_fail_cnt;
+    uint32_t isr_stack_used;
+    uint32_t min_stack_free;    // Least stack headroom of any thread...
+    uint32_t min_stack_thread;  // ...and which thread that is.
+    uint32_t crc;
+} recorder_sample_t;
+
+typedef struct
+{
+    uint32_t head;      // Next slot to write.
+    uint32_t count;
+    uint32_t sequence;  // Of the next sample.
+    uint32_t crc;
+} recorder_header_t;
+
+typedef struct
+{
+    uint32_t                 magic;
+    recorder_header_t        headers[2];
+
+    recorder_sample_t        samples[FLIGHT_RECORDER_SAMPLES];
+
+    memory_status_snapshot_t snapshot;
+    uint32_t                 snapshot_crc;
+} recorder_t;
+
+static recorder_t recorder __attribute__((section(FLIGHT_RECORDER_SECTION)));
+
+static uint32_t recorder_header_crc(const recorder_header_t * header)
+{
+    return crc16_ccitt((const uint8_t *) header, offsetof(recorder_header_t, crc));
+}
+
+static uint32_t recorder_sample_crc(const recorder_sample_t * sample)
+{
+    return crc16_ccitt((const uint8_t *) sample, offsetof(recorder_sample_t, crc));
+}
+
+static uint32_t recorder_snapshot_crc(void)
+{
+    return crc16_ccitt((const uint8_t *) &recorder.snapshot, sizeof(recorder.snapshot));
+}
+
+static bool recorder_header_is_valid(const recorder_header_t * header)
+{
+    return header->crc == recorder_header_crc(header) &&
+           header->head < FLIGHT_RECORDER_SAMPLES &&
+           header->count <= FLIGHT_RECORDER_SAMPLES;
+}
+
+// The valid header with the later sequence, NULL if neither is valid.
+static recorder_header_t * recorder_header(void)
+{
+    if (recorder.magic != FLIGHT_RECORDER_MAGIC) return NULL;
+
+    recorder_header_t * first  = &recorder.headers[0];
+    recorder_header_t * second = &recorder.headers[1];
+
+    if (!recorder_header_is_valid(first))  return recorder_header_is_valid(second) ? second : NULL;
+    if (!recorder_header_is_valid(second)) return first;
+
+    return (int32_t) (second->sequence - first->sequence) > 0 ? second : first;
+}
+
+static recorder_header_t * recorder_reset(void)
+{
+    memset(&recorder, 0, sizeof(recorder));
+
+    recorder.magic          = FLIGHT_RECORDER_MAGIC;
+    recorder.headers[0].crc = recorder_header_crc(&recorder.headers[0]);
+    recorder.headers[1].crc = ~recorder.headers[0].crc;
+    recorder.snapshot_crc   = ~recorder_snapshot_crc();
+
+    return &recorder.headers[0];
+}
+
+void memory_status_record(uint32_t timestamp)
+{
+    const recorder_header_t * current = recorder_header();
+
+    if (!current) current = recorder_reset();
+
+    // Invalidate the old snapshot first, a reset halfway through the copy
+    // must not leave something that looks valid.
+    recorder.snapshot_crc = ~recorder.snapshot_crc;
+
+    memory_status_snapshot(&recorder.snapshot);
+
+    // Names may point into RAM that does not survive a reset.
+    for (uint32_t i = 0; i < recorder.snapshot.thread_count; i++)
+    {
+        recorder.snapshot.threads[i].name = NULL;
+    }
+
+    recorder.snapshot_crc = recorder_snapshot_crc();
+
+    const memory_status_snapshot_t * snapshot = &recorder.snapshot;
+    recorder_sample_t              * sample   = &recorder.samples[current->head];
+
+    sample->sequence         = current->sequence;
+    sample->timestamp        = timestamp;
+    sample->heap_current     = snapshot->heap.current_size;
+    sample->heap_max         = snapshot->heap.max_size;
+    sample->alloc_fail_cnt   = snapshot->heap.alloc_fail_cnt;
+    sample->isr_stack_used   = snapshot->isr_stack.used;
+    sample->min_stack_free   = 0xFFFFFFFF;
+    sample->min_stack_thread = 0;
+
+    for (uint32_t i = 0; i < snapshot->thread_count; i++)
+    {
+        const memory_status_thread_t * thread = &snapshot->threads[i];
+
+        if (thread->stack_size - thread->stack_used < sample->min_stack_free)
+        {
+            sample->min_stack_free   = thread->stack_size - thread->stack_used;
+            sample->min_stack_thread = thread->id;
+        }
+    }
+
+    sample->crc = recorder_sample_crc(sample);
+
+    // The new header goes into the other copy, which is invalidated first.
+    // Until its CRC is written the current one stays valid, so a reset here
+    // loses at most this sample, never the ring.
+    recorder_header_t * next = &recorder.headers[current == &recorder.headers[0]];
+
+    next->crc      = ~recorder_header_crc(next);
+    next->head     = (current->head + 1) % FLIGHT_RECORDER_SAMPLES;
+    next->count    = current->count + (current->count < FLIGHT_RECORDER_SAMPLES);
+    next->sequence = current->sequence + 1;
+    next->crc      = recorder_header_crc(next);
+}
+
+static void print_recorder_sample(const recorder_sample_t * sample)
+{
+    DPL("   sample ( seq: ");
+    debug_print_u32(sample->sequence);
+
+    DPL(" time: ");
+    debug_print_u32(sample->timestamp);
+
+    DPL(" heap: ");
+    debug_print_u32(sample->heap_current);
+
+    DPL(" max: ");
+    debug_print_u32(sample->heap_max);
+
+    DPL(" fail: ");
+    debug_print_u32(sample->alloc_fail_cnt);
+
+    DPL(" isr: ");
+    debug_print_u32(sample->isr_stack_used);
+
+    DPL(" ) min_free ( ");
+    debug_print_u32(sample->min_stack_free);
+
+    DPL(" thread: ");
+    debug_print_u32(sample->min_stack_thread);
+
+    DPL(" )\r\n");
+}
+
+int memory_status_recorder_dump(void)
+{
+    const recorder_header_t * current = recorder_header();
+
+    if (!current)
+    {
+        recorder_reset();
+        return 0;
+    }
+
+    uint32_t head  = current->head;
+    uint32_t count = current->count;
+
+    // A reset between writing a sample and its header: the sample is
+    // complete, so it is the newest one.
+    const recorder_sample_t * pending = &recorder.samples[head];
+
+    if (pending->crc == recorder_sample_crc(pending) && pending->sequence == current->sequence)
+    {
+        head   = (head + 1) % FLIGHT_RECORDER_SAMPLES;
+        count += (count < FLIGHT_RECORDER_SAMPLES);
+    }
+
+    bool snapshot_valid = (recorder.snapshot_crc == recorder_snapshot_crc());
+
+    if (count == 0 && !snapshot_valid) return 0;
+
+    DPL("flight recorder ( samples: ");
+    debug_print_u32(count);
+    DPL(" )\r\n");
+
+    // Oldest first.
+    uint32_t slot = (head + FLIGHT_RECORDER_SAMPLES - count) % FLIGHT_RECORDER_SAMPLES;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const recorder_sample_t * sample = &recorder.samples[slot];
+
+        if (sample->crc == recorder_sample_crc(sample))
+        {
+            print_recorder_sample(sample);
+        }
+        else
+        {
+            DPL("   sample ( corrupt )\r\n");
+        }
+
+        slot = (slot + 1) % FLIGHT_RECORDER_SAMPLES;
+    }
+
+    if (snapshot_valid)
+    {
+        const memory_status_snapshot_t * snapshot = &recorder.snapshot;
+
+#if MEMORY_STATUS_RTOS != MEMORY_STATUS_RTOS_NONE
+        for (uint32_t i = 0; i < snapshot->thread_count && i < MEMORY_STATUS_MAX_THREADS; i++)
+        {
+            print_thread_info(&snapshot->threads[i]);
+        }
+#endif
+
+        print_heap_line(&snapshot->heap);
+        print_isr_stack_line(&snapshot->isr_stack);
+    }
+
+    recorder_reset();
+
+    return 1;
+}
+#endif // DEBUG_FLIGHT_RECORDER
+
+#if DEBUG_RTT_COMMANDS
+// Line-based command interpreter on the RTT down-buffer, so that a host
+// can pull reports on demand (e.g. by typing into J-Link RTT Viewer):
+//
+//   threads                  print_all_thread_info()
+//   heap                     heap line only
+//   isr                      ISR stack line only
+//   dump <start> <length>    hex dump of RAM or flash, both arguments in hex
+//   sampler start <hz>       memory_status_sampler_start(), hz in decimal
+//   sampler stop             memory_status_sampler_stop(), then prints the samples
+//
+// Anything else prints the list of commands.
+
+enum
+{
+    RTT_COMMAND_LINE_LENGTH = 48
+};
+
+#ifndef DUMP_MAX_LENGTH
+#define DUMP_MAX_LENGTH  0x400 // Bytes per dump command; longer ones are cut short.
+#endif
+
+// What dump will read: RAM, from the same GCC_ARM linker script symbols
+// as the fault dump, and flash where mbed's tools pass MBED_ROM_START and
+// MBED_ROM_SIZE. Anything else may be unmapped, or a peripheral whose
+// registers change when read. Define these for other toolchains.
+#ifndef DUMP_RAM_START
+extern uint32_t __data_start__;
+#define DUMP_RAM_START    ((uint32_t) (uintptr_t) &__data_start__)
+#endif
+
+#ifndef DUMP_RAM_END
+extern uint32_t __StackTop;
+#define DUMP_RAM_END      ((uint32_t) (uintptr_t) &__StackTop)
+#endif
+
+#ifndef DUMP_FLASH_START
+#if defined (MBED_ROM_START) && defined (MBED_ROM_SIZE)
+#define DUMP_FLASH_START  ((uint32_t) MBED_ROM_START)
+#define DUMP_FLASH_END    ((uint32_t) (MBED_ROM_START + MBED_ROM_SIZE))
+#else
+#define DUMP_FLASH_START  0
+#define DUMP_FLASH_END    0 // Empty: no flash dumps.
+#endif
+#endif
+
+static char     rtt_command_line[RTT_COMMAND_LINE_LENGTH];
+static uint32_t rtt_command_length = 0;
+
+static bool command_is(const char * line, const char * command, const char ** args)
+{
+    while (*command)
+    {
+        if (*line++ != *command++) return false;
+    }
+
+    if (*line != '\0' && *line != ' ') return false;
+
+    *args = line;
+    return true;
+}
+
+static const char * parse_hex_u32(const char * text, uint32_t * value)
+{
+    while (*text == ' ') text++;
+
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) text += 2;
+
+    const char * start = text;
+    uint32_t     result = 0;
+
+    for (;; text++)
+    {
+        char c = *text;
+
+        if      (c >= '0' && c <= '9') result = (result << 4) | (uint32_t) (c - '0');
+        else if (c >= 'a' && c <= 'f') result = (result << 4) | (uint32_t) (c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') result = (result << 4) | (uint32_t) (c - 'A' + 10);
+        else break;
+    }
+
+    if (text == start) return NULL;
+
+    *value = result;
+    return text;
+}
+
+#if DEBUG_PC_SAMPLER
+static const char * parse_dec_u32(const char * text, uint32_t * value)
+{
+    while (*text == ' ') text++;
+
+    const char * start  = text;
+    uint32_t     result = 0;
+
+    for (; *text >= '0' && *text <= '9'; text++)
+    {
+        result = result * 10 + (uint32_t) (*text - '0');
+    }
+
+    if (text == start) return NULL;
+
+    *value = result;
+    return text;
+}
+
+static void print_pc_samples(void)
+{
+    memory_status_pc_sample_t sample;
+
+    while (memory_status_sampler_read(&sample, sizeof(sample)))
+    {
+        if (0 == sample.thread)
+        {
+            DPL("pc_sampler ( hz: ");
+            debug_print_u32(sample.pc);
+            DPL(" dropped: ");
+            debug_print_u32(sample.count);
+            DPL(" )\r\n");
+            continue;
+        }
+
+        DPL("   sample ( thread: ");
+        debug_print_u32(sample.thread);
+        DPL(" pc: ");
+        debug_print_u32(sample.pc);
+        DPL(" count: ");
+        debug_print_u32(sample.count);
+        DPL(" )\r\n");
+    }
+}
+#endif
+
+static bool dump_range_within(uint32_t start, uint32_t length, uint32_t region_start, uint32_t region_end)
+{
+    return start >= region_start && start < region_end && length <= region_end - start;
+}
+
+static bool dump_range_valid(uint32_t start, uint32_t length)
+{
+    return dump_range_within(start, length, DUMP_RAM_START, DUMP_RAM_END) ||
+           dump_range_within(start, length, DUMP_FLASH_START, DUMP_FLASH_END);
+}
+
+static void run_rtt_command(const char * line)
+{
+    const char * args = NULL;
+
+#if MEMORY_STATUS_RTOS != MEMORY_STATUS_RTOS_NONE
+    if (command_is(line, "threads", &args))
+    {
+        print_all_thread_info();
+        return;
+    }
+#endif
+
+    if (command_is(line, "heap", &args))
+    {
+        print_heap_info();
+        return;
+    }
+
+    if (command_is(line, "isr", &args))
+    {
+        print_isr_stack_info();
+        return;
+    }
+
+    if (command_is(line, "dump", &args))
+    {
+        uint32_t start  = 0;
+        uint32_t length = 0;
+
+        if ((args = parse_hex_u32(args, &start)) && parse_hex_u32(args, &length))
+        {
+            if (length > DUMP_MAX_LENGTH) length = DUMP_MAX_LENGTH;
+
+            // Word aligned, since print_memory_contents() reads 32 bits at
+            // a time, so the last word is read whole.
+            start &= ~3U;
+
+            if (dump_range_valid(start, (length + 3) & ~3U))
+            {
+                print_memory_contents((const uint32_t *) (uintptr_t) start, (const uint32_t *) (uintptr_t) (start + length));
+                DPL("\r\n");
+                return;
+            }
+        }
+    }
+
+#if DEBUG_PC_SAMPLER
+    if (command_is(line, "sampler", &args))
+    {
+        uint32_t hz = 0;
+
+        while (*args == ' ') args++;
+
+        if (command_is(args, "start", &args) && parse_dec_u32(args, &hz))
+        {
+            memory_status_sampler_start(hz);
+            return;
+        }
+
+        if (command_is(args, "stop", &args))
+        {
+            memory_status_sampler_stop();
+            print_pc_samples();
+            return;
+        }
+    }
+
+    DPL("commands: threads | heap | isr | dump <start> <length> | sampler start <hz> | sampler stop\r\n");
+#else
+    DPL("commands: threads | heap | isr | dump <start> <length>\r\n");
+#endif
+}
+
+void poll_memory_status_commands(void)
+{
+    char c;
+
+    while (SEGGER_RTT_Read(DEFAULT_RTT_DOWN_BUFFER, &c, 1) == 1)
+    {
+        if (c == '\r' || c == '\n')
+        {
+            if (rtt_command_length == 0) continue;
+
+            rtt_command_line[rtt_command_length] = '\0';
+            rtt_command_length = 0;
+
+            run_rtt_command(rtt_command_line);
+        }
+        else if (rtt_command_length < RTT_COMMAND_LINE_LENGTH - 1)
+        {
+            rtt_command_line[rtt_command_length++] = c;
+        }
+    }
 }
+#endif // DEBUG_RTT_COMMANDS
@@ -24,8 +24,194 @@
 #ifndef MEMORY_STATUS_H
 #define MEMORY_STATUS_H
 
+#include <stdint.h>
+
+#ifndef MEMORY_STATUS_MAX_THREADS
+#define MEMORY_STATUS_MAX_THREADS  16
+#endif
+
+// Raw numbers behind the printed report, for callers that want to ship
+// them in their own format. Addresses are target addresses.
+typedef struct
+{
+    uint32_t     stack_start;
+    uint32_t     stack_end;
+    uint32_t     stack_size;
+    uint32_t     stack_used;
+
+    uint32_t     id;
+    uint32_t     entry;
+    const char * name;      // NULL if unnamed (always NULL on CMSIS-RTOS 1).
+    int32_t      state;     // As reported by the RTOS, not normalized.
+    int32_t      priority;
+} memory_status_thread_t;
+
+typedef struct
+{
+    uint32_t start;
+    uint32_t end;
+    uint32_t size;
+
+    // From mbed_stats_heap_t.
+    uint32_t current_size;
+    uint32_t max_size;
+    uint32_t total_size;
+    uint32_t alloc_cnt;
+    uint32_t alloc_fail_cnt;
+} memory_status_heap_t;
+
+typedef struct
+{
+    uint32_t start;
+    uint32_t end;
+    uint32_t size;
+    uint32_t used;          // 0 unless built with DEBUG_ISR_STACK_USAGE=1.
+} memory_status_isr_stack_t;
+
+typedef struct
+{
+    uint32_t                  thread_count;   // Entries filled in threads[].
+    uint32_t                  thread_total;   // Threads that exist, may be > thread_count.
+    memory_status_thread_t    threads[MEMORY_STATUS_MAX_THREADS];
+
+    memory_status_heap_t      heap;
+    memory_status_isr_stack_t isr_stack;
+} memory_status_snapshot_t;
+
+// Fills in the snapshot without printing or allocating anything.
+void memory_status_snapshot(memory_status_snapshot_t * snapshot);
+
+// Pull-based report, only available when built with DEBUG_STREAM=1.
+// memory_status_stream_begin() takes a snapshot; each
+// memory_status_stream_read() then returns up to size further bytes of the
+// report, and 0 once it is complete. Text is the same as the printed
+// report; binary is the snapshot's fields in the fixed little-endian
+// layout described in the README.
+enum
+{
+    MEMORY_STATUS_STREAM_TEXT   = 0,
+    MEMORY_STATUS_STREAM_BINARY = 1
+};
+
+void     memory_status_stream_begin(int format);
+uint32_t memory_status_stream_read(void * buffer, uint32_t size);
+
+// Flight recorder, only available when built with DEBUG_FLIGHT_RECORDER=1.
+// Call memory_status_record() periodically, with any timestamp you like.
+// Call memory_status_recorder_dump() once at boot: if samples survived the
+// last reset it prints them, plus the last snapshot, and returns 1.
+void memory_status_record(uint32_t timestamp);
+int  memory_status_recorder_dump(void);
+
+// Fault dump, only available when built with DEBUG_FAULT_DUMP=1. Safe to
+// call from a fault handler: no RTOS calls, no locks, bounded run time.
+// sp is the stack pointer of the faulting context.
+void print_fault_memory_status(uint32_t sp);
+
+// Thread switch accounting, only available when built with
+// DEBUG_THREAD_CPU_TIME=1 or DEBUG_SCHED_LATENCY=1. Hooked up to RTX5's
+// thread events automatically, which those need; the functions take the
+// id of the thread about to run / just made ready / just deleted.
+// memory_status_thread_destroyed() is also there with DEBUG_ALLOC_TAGS=1,
+// to drop the deleted thread's tag; call it yourself where RTX5's thread
+// events are off.
+void memory_status_thread_switched(void * thread);
+void memory_status_thread_ready(void * thread);
+void memory_status_thread_destroyed(void * thread);
+
+// Live stack depth, only available when built with DEBUG_STACK_SAMPLER=1.
+// Call periodically from a thread; every call records each thread's
+// current depth, and print_all_thread_info() shows the distribution.
+// With DEBUG_QUANTILES=1 it also keeps p50 / p90 / p99 / max since boot
+// of every thread's depth and of the heap's current_size.
+void memory_status_stack_sample(void);
+
+// Allocation lifetime, only available when built with
+// DEBUG_ALLOC_LIFETIME=1 and MBED_MEM_TRACING_ENABLED=1. Installs the mbed
+// memory trace callback; blocks allocated before the call are ignored.
+void memory_status_heap_trace_begin(void);
+
+// Allocation tags, only available when built with DEBUG_ALLOC_TAGS=1 and
+// the allocator wrapped (see README). Blocks allocated while a MemTagScope
+// is alive on the calling thread are charged to its tag:
+//
+//     MemTagScope tag("tls");
+//
+// Tags are compared by pointer first, so string literals are cheapest. A
+// NULL name leaves the current tag as it is. MEMORY_STATUS_TAG_ERROR,
+// counted in the report, if there was no room to give the calling thread
+// a tag (raise ALLOC_TAG_THREADS); its tag is then left as it is, and
+// leaving with MEMORY_STATUS_TAG_ERROR does nothing.
+#define MEMORY_STATUS_TAG_ERROR  0xFFFFFFFF
+
+uint32_t memory_status_tag_enter(const char * name);
+void     memory_status_tag_leave(uint32_t previous);
+
+// Quotas, only available when also built with DEBUG_ALLOC_QUOTAS=1.
+// Allocations that would take the tag's live bytes over the quota fail
+// with NULL and are counted in the report. name NULL is "untagged",
+// bytes 0 removes the quota. false, and counted in the report, if name is
+// new and the tag table is full.
+bool     memory_status_tag_quota(const char * name, uint32_t bytes);
+
+class MemTagScope
+{
+public:
+    explicit MemTagScope(const char * name) : previous(memory_status_tag_enter(name)) {}
+    ~MemTagScope() { memory_status_tag_leave(previous); }
+
+private:
+    uint32_t previous;
+
+    // Not copyable, it restores the tag exactly once.
+    MemTagScope(const MemTagScope &);
+    MemTagScope & operator=(const MemTagScope &);
+};
+
+// PC sampling profiler, only available when built with DEBUG_PC_SAMPLER=1.
+// memory_status_sampler_start() clears the histogram and samples the
+// running thread's PC hz times a second (10 to 10000).
+// memory_status_sampler_stop() stops sampling; each
+// memory_status_sampler_read() then returns further whole records, and 0
+// once all have been read. The first record is a header: thread 0, pc the
+// sample rate in Hz, count the samples dropped because the table was full.
+typedef struct
+{
+    uint32_t thread;
+    uint32_t pc;            // Start of the block of addresses sampled.
+    uint32_t count;
+} memory_status_pc_sample_t;
+
+void     memory_status_sampler_start(uint32_t hz);
+void     memory_status_sampler_stop(void);
+uint32_t memory_status_sampler_read(void * buffer, uint32_t size);
+
 void print_current_thread_id(void);
 void print_all_thread_info(void);
 void print_heap_and_isr_stack_info(void);
 
+// Only available when built with DEBUG_RTT_COMMANDS=1. Call periodically
+// from a low-priority thread or the idle hook.
+void poll_memory_status_commands(void);
+
+// What the last print_all_thread_info() / print_heap_and_isr_stack_info()
+// call cost. Times are in ticks: CPU cycles where the DWT cycle counter
+// exists, microseconds otherwise (see ticks_per_second).
+typedef struct
+{
+    uint32_t ticks_per_second;
+    uint32_t total_ticks;
+    uint32_t kernel_locked_ticks;
+
+    uint32_t serial_ticks;
+    uint32_t serial_bytes;
+    uint32_t rtt_ticks;
+    uint32_t rtt_bytes;
+    uint32_t swo_ticks;
+    uint32_t swo_bytes;
+} memory_status_cost_t;
+
+// Only available when built with DEBUG_SELF_COST=1.
+void get_memory_status_cost(memory_status_cost_t * cost);
+
 #endif /* MEMORY_STATUS_H */
@@ -0,0 +1,186 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Decode the framed output produced with OUTPUT_FRAMING=1 back
+ *          into text, and count exactly how many records were lost or
+ *          corrupted on the way.
+ *
+ * Host tool, not part of the firmware build:
+ *
+ *   cc -O2 -o frame_decode tools/frame_decode.c
+ *   frame_decode < capture.bin
+ *
+ * Text goes to stdout; a marker line is inserted wherever records went
+ * missing, and a summary is printed to stderr at the end of input.
+ *
+ * Record format (see mbed_memory_status.cpp):
+ *
+ *   COBS( seq_lo seq_hi payload... crc_lo crc_hi ) 0x00
+ *
+ * with CRC-16/CCITT-FALSE over seq and payload.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+enum
+{
+    MAX_FRAME_SIZE = 1024
+};
+
+static uint16_t crc16_ccitt(const uint8_t * data, uint32_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    while (length--)
+    {
+        crc ^= (uint16_t) (*data++ << 8);
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+// Returns the decoded length, or -1 if the frame is malformed.
+static int32_t cobs_decode(const uint8_t * input, uint32_t length, uint8_t * output)
+{
+    uint32_t in  = 0;
+    uint32_t out = 0;
+
+    while (in < length)
+    {
+        uint8_t code = input[in++];
+
+        if (0 == code || in + code - 1 > length) return -1;
+
+        for (uint8_t i = 1; i < code; i++)
+        {
+            output[out++] = input[in++];
+        }
+
+        if (code != 0xFF && in < length)
+        {
+            output[out++] = 0x00;
+        }
+    }
+
+    return (int32_t) out;
+}
+
+typedef struct
+{
+    uint32_t records;
+    uint32_t lost;
+    uint32_t corrupted;
+    uint32_t have_sequence;
+    uint16_t next_sequence;
+} decoder_stats_t;
+
+static void handle_frame(decoder_stats_t * stats, const uint8_t * frame, uint32_t length)
+{
+    static uint8_t record[MAX_FRAME_SIZE];
+
+    int32_t decoded = cobs_decode(frame, length, record);
+
+    if (decoded < 4)
+    {
+        stats->corrupted++;
+        return;
+    }
+
+    uint32_t size = (uint32_t) decoded - 2;
+    uint16_t crc  = (uint16_t) (record[size] | (record[size + 1] << 8));
+
+    if (crc16_ccitt(record, size) != crc)
+    {
+        stats->corrupted++;
+        return;
+    }
+
+    uint16_t sequence = (uint16_t) (record[0] | (record[1] << 8));
+
+    if (stats->have_sequence && sequence != stats->next_sequence)
+    {
+        uint16_t missing = (uint16_t) (sequence - stats->next_sequence);
+
+        stats->lost += missing;
+        printf("\n[... %u record(s) lost ...]\n", (unsigned) missing);
+    }
+
+    stats->have_sequence = 1;
+    stats->next_sequence = (uint16_t) (sequence + 1);
+    stats->records++;
+
+    fwrite(record + 2, 1, size - 2, stdout);
+}
+
+int main(void)
+{
+    static uint8_t  frame[MAX_FRAME_SIZE];
+    uint32_t        length   = 0;
+    int             overflow = 0;
+    int             c;
+    decoder_stats_t stats    = { 0, 0, 0, 0, 0 };
+
+    while ((c = getchar()) != EOF)
+    {
+        if (0 == c)
+        {
+            if (overflow)
+            {
+                stats.corrupted++;
+            }
+            else if (length)
+            {
+                handle_frame(&stats, frame, length);
+            }
+
+            length   = 0;
+            overflow = 0;
+        }
+        else if (length < MAX_FRAME_SIZE)
+        {
+            frame[length++] = (uint8_t) c;
+        }
+        else
+        {
+            overflow = 1;
+        }
+    }
+
+    // A trailing partial frame means the capture was cut off mid-record.
+    if (length)
+    {
+        stats.corrupted++;
+    }
+
+    fprintf(stderr, "records: %u lost: %u corrupted: %u\n",
+            (unsigned) stats.records, (unsigned) stats.lost, (unsigned) stats.corrupted);
+
+    return (stats.lost || stats.corrupted) ? 1 : 0;
+}
@@ -0,0 +1,287 @@
+/*
+    mbed Memory Status Helper
+    Copyright (c) 2017 Max Vilimpoc
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/**
+ * Purpose: Recover RTT output from a raw RAM image taken off a hung or
+ *          crashed device, without a live J-Link session.
+ *
+ * Host tool, not part of the firmware build:
+ *
+ *   cc -O2 -o rtt_extract tools/rtt_extract.c
+ *   rtt_extract ram.bin 20000000
+ *
+ * The second argument is the target address of the first byte of the
+ * image (hex), needed to resolve the pointers in the control block.
+ *
+ * The image is searched for the "SEGGER RTT" id that _DoInit() writes
+ * into the control block. Every candidate whose aUp[] / aDown[]
+ * descriptors point inside the image is reported. For each up-buffer,
+ * the bytes the host has already read but which have not been
+ * overwritten yet are printed first ("history"), followed by the bytes
+ * not read yet ("unread"), so the output is in the order it was written.
+ *
+ * Assumes a 32-bit little-endian target (Cortex-M).
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char RTT_ID[] = "SEGGER RTT";
+
+enum
+{
+    RTT_ID_SIZE     = 16, // sizeof(SEGGER_RTT_CB::acID)
+    RTT_BUFFER_SIZE = 24, // sizeof(SEGGER_RTT_BUFFER_UP), 6 words
+    RTT_MAX_BUFFERS = 32  // Sanity limit on MaxNumUp/DownBuffers.
+};
+
+typedef struct
+{
+    const uint8_t * data;
+    uint32_t        size;
+    uint32_t        base;
+} ram_image_t;
+
+typedef struct
+{
+    uint32_t name;
+    uint32_t buffer;
+    uint32_t size;
+    uint32_t wr_off;
+    uint32_t rd_off;
+    uint32_t flags;
+} rtt_buffer_t;
+
+static uint32_t read_u32(const uint8_t * p)
+{
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static int image_contains(const ram_image_t * image, uint32_t address, uint32_t length)
+{
+    if (address < image->base) return 0;
+
+    uint32_t offset = address - image->base;
+
+    return offset <= image->size && length <= image->size - offset;
+}
+
+static const uint8_t * image_at(const ram_image_t * image, uint32_t address)
+{
+    return image->data + (address - image->base);
+}
+
+static void read_buffer_descriptor(const uint8_t * p, rtt_buffer_t * buffer)
+{
+    buffer->name   = read_u32(p +  0);
+    buffer->buffer = read_u32(p +  4);
+    buffer->size   = read_u32(p +  8);
+    buffer->wr_off = read_u32(p + 12);
+    buffer->rd_off = read_u32(p + 16);
+    buffer->flags  = read_u32(p + 20);
+}
+
+// Unused descriptors have a NULL buffer. Used ones must lie inside the image.
+static int buffer_is_valid(const ram_image_t * image, const rtt_buffer_t * buffer)
+{
+    if (0 == buffer->buffer) return 1;
+
+    return buffer->size > 0 &&
+           buffer->wr_off < buffer->size &&
+           buffer->rd_off < buffer->size &&
+           image_contains(image, buffer->buffer, buffer->size);
+}
+
+static void print_name(const ram_image_t * image, uint32_t name)
+{
+    if (name && image_contains(image, name, 1))
+    {
+        const char * s   = (const char *) image_at(image, name);
+        size_t       max = image->size - (name - image->base);
+        size_t       len = strnlen(s, max < 32 ? max : 32);
+
+        printf("\"%.*s\"", (int) len, s);
+    }
+    else
+    {
+        printf("(name at %08X)", (unsigned) name);
+    }
+}
+
+// Writes count bytes of the ring starting at from, wrapping at the end.
+// Skips NUL bytes, which is what never-written parts of a zero-initialized
+// buffer hold.
+static void write_ring(const uint8_t * ring, uint32_t size, uint32_t from, uint32_t count)
+{
+    for (; count; count--)
+    {
+        if (ring[from]) putchar(ring[from]);
+        if (++from == size) from = 0;
+    }
+}
+
+static void dump_up_buffer(const ram_image_t * image, uint32_t index, const rtt_buffer_t * buffer)
+{
+    if (0 == buffer->buffer) return;
+
+    const uint8_t * ring   = image_at(image, buffer->buffer);
+    uint32_t        unread = (buffer->wr_off + buffer->size - buffer->rd_off) % buffer->size;
+
+    printf("  up[%u] ", (unsigned) index);
+    print_name(image, buffer->name);
+    printf(" ( buffer: %08X size: %08X wr: %08X rd: %08X flags: %08X unread: %08X )\n",
+           (unsigned) buffer->buffer, (unsigned) buffer->size,
+           (unsigned) buffer->wr_off, (unsigned) buffer->rd_off,
+           (unsigned) buffer->flags,  (unsigned) unread);
+
+    // Oldest byte still in the ring is the one at the write position,
+    // everything from there up to the read position was already read.
+    printf("--- history ---\n");
+    write_ring(ring, buffer->size, buffer->wr_off, buffer->size - unread);
+
+    printf("\n--- unread ---\n");
+    write_ring(ring, buffer->size, buffer->rd_off, unread);
+
+    printf("\n--- end ---\n");
+}
+
+static int try_control_block(const ram_image_t * image, uint32_t offset)
+{
+    if (image->size - offset < RTT_ID_SIZE + 8) return 0;
+
+    const uint8_t * cb       = image->data + offset;
+    uint32_t        num_up   = read_u32(cb + RTT_ID_SIZE);
+    uint32_t        num_down = read_u32(cb + RTT_ID_SIZE + 4);
+
+    if (num_up == 0 || num_up > RTT_MAX_BUFFERS || num_down > RTT_MAX_BUFFERS) return 0;
+
+    uint32_t cb_size = RTT_ID_SIZE + 8 + (num_up + num_down) * RTT_BUFFER_SIZE;
+
+    if (image->size - offset < cb_size) return 0;
+
+    rtt_buffer_t up[RTT_MAX_BUFFERS];
+    rtt_buffer_t down;
+
+    for (uint32_t i = 0; i < num_up; i++)
+    {
+        read_buffer_descriptor(cb + RTT_ID_SIZE + 8 + i * RTT_BUFFER_SIZE, &up[i]);
+        if (!buffer_is_valid(image, &up[i])) return 0;
+    }
+
+    for (uint32_t i = 0; i < num_down; i++)
+    {
+        read_buffer_descriptor(cb + RTT_ID_SIZE + 8 + (num_up + i) * RTT_BUFFER_SIZE, &down);
+        if (!buffer_is_valid(image, &down)) return 0;
+    }
+
+    printf("control block ( address: %08X up: %08X down: %08X )\n",
+           (unsigned) (image->base + offset), (unsigned) num_up, (unsigned) num_down);
+
+    for (uint32_t i = 0; i < num_up; i++)
+    {
+        dump_up_buffer(image, i, &up[i]);
+    }
+
+    return 1;
+}
+
+// memchr() is vectorized in any reasonable libc, so scanning for the
+// first byte of the id and only then comparing keeps multi-megabyte
+// images in the millisecond range.
+static uint32_t find_control_blocks(const ram_image_t * image)
+{
+    const uint8_t * p     = image->data;
+    const uint8_t * end   = image->data + image->size;
+    uint32_t        found = 0;
+
+    while ((p = (const uint8_t *) memchr(p, RTT_ID[0], (size_t) (end - p))) != NULL)
+    {
+        if ((size_t) (end - p) >= sizeof(RTT_ID) && 0 == memcmp(p, RTT_ID, sizeof(RTT_ID)))
+        {
+            found += try_control_block(image, (uint32_t) (p - image->data));
+        }
+
+        p++;
+    }
+
+    return found;
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s <ram image> <image base address, hex>\n", argv[0]);
+        return 2;
+    }
+
+    FILE * file = fopen(argv[1], "rb");
+
+    if (!file)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (size <= 0 || (unsigned long) size > 0xFFFFFFFFUL)
+    {
+        fprintf(stderr, "%s: unsupported image size\n", argv[1]);
+        fclose(file);
+        return 1;
+    }
+
+    uint8_t * data = (uint8_t *) malloc((size_t) size);
+
+    if (!data || fread(data, 1, (size_t) size, file) != (size_t) size)
+    {
+        fprintf(stderr, "%s: read failed\n", argv[1]);
+        fclose(file);
+        free(data);
+        return 1;
+    }
+
+    fclose(file);
+
+    ram_image_t image;
+
+    image.data = data;
+    image.size = (uint32_t) size;
+    image.base = (uint32_t) strtoul(argv[2], NULL, 16);
+
+    uint32_t found = find_control_blocks(&image);
+
+    if (0 == found)
+    {
+        fprintf(stderr, "no valid RTT control block found\n");
+    }
+
+    free(data);
+
+    return found ? 0 : 1;
+}